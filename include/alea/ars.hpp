@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+//
+// This work is derivated from the boost.Random123
+// repository accessible here https://github.com/DEShawResearch/Random123-Boost
+//
+//
+
+#ifndef _ALEA_RANDOM_ARS_
+#define _ALEA_RANDOM_ARS_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "impl/aes_soft.hpp"
+#include "impl/simd_dispatch.hpp"
+#include "threefry.hpp"
+
+///
+///  ars ( Advanced Randomization System ) is a state-less counter based
+///  random generator built from the rounds of the AES block cipher
+///  with a simplified Weyl sequence key schedule
+///
+///   ars has been presented at SC11 in the publication
+///
+/// "Parallel random numbers: as easy as 1, 2, 3".
+///    John K. Salmon, Mark A. Moraes, Ron O. Dror, David E. Shaw"
+///    (doi:10.1145/2063384.2063405)
+///
+///  ars-5 is the smallest crush-resistant number of rounds, the default
+///  of 7 rounds is the one of Random123
+///
+///  The AES-NI instructions are used when the running CPU supports them,
+///  otherwise a portable software implementation of the AES rounds
+///  (impl/aes_soft.hpp) gives the same results, much slower
+///
+
+namespace alea {
+
+namespace impl {
+
+// 64 bits Weyl sequence increments of the low and high key halves
+constexpr std::uint64_t ars_weyl[2] = {UINT64_C(0x9E3779B97F4A7C15),
+                                       UINT64_C(0xBB67AE8584CAA73B)};
+
+} // namespace impl
+
+template <unsigned R = 7> class ars {
+    static_assert(R >= 1 && R <= 10, "number of rounds should be in [1, 10]");
+
+  public:
+    typedef utils::array<std::uint32_t, 4> domain_type;
+    typedef utils::array<std::uint32_t, 4> range_type;
+    typedef utils::array<std::uint32_t, 4> key_type;
+    typedef std::uint32_t uint_type;
+
+    explicit ars() : k() {}
+    explicit ars(key_type _k) : k(_k) {}
+
+    ars(const ars &) = default;
+    ars(ars &&) = default;
+
+    ars &operator=(const ars &) = default;
+    ars &operator=(ars &&) = default;
+
+    void set_key(key_type _k) { k = _k; }
+
+    key_type get_key() const { return k; }
+
+    bool operator==(const ars &rhs) const { return k == rhs.k; }
+    bool operator!=(const ars &rhs) const { return k != rhs.k; }
+
+    inline range_type operator()(const domain_type &counter) const {
+        range_type res;
+        encrypt_blocks(impl::aes_impl_best(), counter, res.data(), 1);
+        return res;
+    }
+
+    /// encrypt the nblocks consecutive counters starting at counter
+    /// and write the 4 * nblocks output words to out
+    inline void operator()(const domain_type &counter, uint_type *out,
+                           std::size_t nblocks) const {
+        encrypt_blocks(impl::aes_impl_best(), counter, out, nblocks);
+    }
+
+    /// same as the bulk operator() with an explicit aes implementation
+    void encrypt_blocks(impl::aes_impl aes, const domain_type &counter,
+                        uint_type *out, std::size_t nblocks) const;
+
+  private:
+    /// the R + 1 round keys: key + r * weyl on each 64 bits half
+    inline std::array<impl::aes_block, R + 1> round_keys() const;
+
+    key_type k;
+};
+
+typedef ars<7> ars4x32;
+
+} // namespace alea
+
+#include "impl/ars_impl.hpp"
+
+#endif // _ALEA_RANDOM_ARS_
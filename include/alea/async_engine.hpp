@@ -0,0 +1,289 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_ASYNC_ENGINE_HPP_
+#define _ALEA_ASYNC_ENGINE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+
+#include "impl/cache_line.hpp"
+#include "impl/engine_fill.hpp"
+
+///
+/// async_engine<Engine> moves the generation of Engine to a producer
+/// thread, which writes its values ahead of the consumer into a lock-free
+/// single producer / single consumer ring
+///
+///    alea::async_engine<alea::counter_engine<alea::threefry4x64>> engine(
+///        alea::counter_engine<alea::threefry4x64>(42));
+///    double x = dist(engine); // a load and an index bump
+///
+/// The values are the ones of Engine, in the same order. The producer
+/// writes chunks of chunk_size values and waits when the ring is full
+/// ( backpressure ), the consumer waits when it is empty; both spin a
+/// little, then yield, then sleep.
+///
+/// The consumer publishes its position once per chunk, the producer once
+/// per chunk too: the shared indices move by chunks, each on its own
+/// cache line. stats() gives the waits of both sides and the histograms
+/// of the consumer stalls and of the chunk generation times.
+///
+/// One thread consumes, the one that calls operator(), generate_n and
+/// stats().
+///
+
+namespace alea {
+
+/// histogram of durations, bucket i counts the durations of
+/// [2^(i-1), 2^i) nanoseconds, bucket 0 the zero ones
+struct latency_histogram {
+    static constexpr std::size_t n_buckets = 40;
+
+    std::array<std::uint64_t, n_buckets> buckets{};
+
+    static std::size_t bucket(std::uint64_t ns) {
+        std::size_t res = 0;
+        for (; ns != 0 && res + 1 < n_buckets; ns >>= 1) {
+            ++res;
+        }
+        return res;
+    }
+
+    void record(std::uint64_t ns) { ++buckets[bucket(ns)]; }
+
+    std::uint64_t count() const {
+        std::uint64_t res = 0;
+        for (std::uint64_t n : buckets) {
+            res += n;
+        }
+        return res;
+    }
+};
+
+struct async_engine_stats {
+    /// times the consumer found the ring empty
+    std::uint64_t consumer_stalls = 0;
+    /// times the producer found the ring full
+    std::uint64_t producer_waits = 0;
+    /// chunks written by the producer
+    std::uint64_t chunks = 0;
+    /// durations of the consumer stalls
+    latency_histogram stall_ns;
+    /// generation time of the chunks
+    latency_histogram chunk_ns;
+};
+
+template <typename Engine> class async_engine {
+  public:
+    typedef Engine engine_type;
+    typedef typename Engine::result_type result_type;
+
+    static constexpr std::size_t default_capacity = std::size_t(1) << 16;
+    static constexpr std::size_t default_chunk = 1024;
+
+    /// start the producer on engine, capacity and chunk_size are rounded
+    /// up to powers of two, capacity holds two chunks at least
+    explicit async_engine(const Engine &engine,
+                          std::size_t capacity = default_capacity,
+                          std::size_t chunk_size = default_chunk)
+        : _engine(engine), _chunk(round_up(chunk_size)),
+          _capacity(std::max(round_up(capacity), 2 * _chunk)),
+          _mask(_capacity - 1), _ring(new result_type[_capacity]), _pos(0),
+          _limit(0), _stats(), _head(0), _tail(0), _stop(false),
+          _producer_waits(0), _chunks(0), _chunk_ns() {
+        _producer = std::thread([this] { produce(); });
+    }
+
+    async_engine(const async_engine &) = delete;
+    async_engine &operator=(const async_engine &) = delete;
+
+    ~async_engine() {
+        _stop.store(true, std::memory_order_relaxed);
+        _producer.join();
+    }
+
+    static constexpr result_type min() { return Engine::min(); }
+
+    static constexpr result_type max() { return Engine::max(); }
+
+    result_type operator()() {
+        if (_pos == _limit) {
+            acquire();
+        }
+        return _ring[_pos++ & _mask];
+    }
+
+    /// write the n next values to first
+    template <typename OutputIterator>
+    OutputIterator generate_n(OutputIterator first, std::size_t n) {
+        while (n > 0) {
+            if (_pos == _limit) {
+                acquire();
+            }
+            const std::size_t count =
+                std::min<std::size_t>(n, std::size_t(_limit - _pos));
+            const result_type *values = _ring.get() + (_pos & _mask);
+            first = std::copy(values, values + count, first);
+            _pos += count;
+            n -= count;
+        }
+        return first;
+    }
+
+    std::size_t capacity() const { return _capacity; }
+
+    std::size_t chunk_size() const { return _chunk; }
+
+    /// statistics so far, the producer ones are approximate while it runs
+    /// but chunk_ns.count() never exceeds chunks
+    async_engine_stats stats() const {
+        async_engine_stats res(_stats);
+        for (std::size_t i = 0; i < latency_histogram::n_buckets; ++i) {
+            res.chunk_ns.buckets[i] =
+                _chunk_ns[i].load(std::memory_order_acquire);
+        }
+        res.chunks = _chunks.load(std::memory_order_relaxed);
+        res.producer_waits = _producer_waits.load(std::memory_order_relaxed);
+        return res;
+    }
+
+  private:
+    typedef std::chrono::steady_clock clock_type;
+
+    static std::size_t round_up(std::size_t n) {
+        std::size_t res = 1;
+        while (res < n) {
+            res <<= 1;
+        }
+        return res;
+    }
+
+    /// spin, then yield, then sleep, as the wait gets longer
+    static void backoff(std::size_t &round) {
+        if (round < 64) {
+            // spin
+        } else if (round < 256) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+        ++round;
+    }
+
+    /// give back the consumed chunk, then take the next one, at most a
+    /// chunk so that the producer sees the free room early
+    void acquire() {
+        _tail.store(_pos, std::memory_order_release);
+
+        std::uint64_t head = _head.load(std::memory_order_acquire);
+        if (head == _pos) {
+            ++_stats.consumer_stalls;
+            const clock_type::time_point start = clock_type::now();
+            for (std::size_t round = 0; head == _pos; backoff(round)) {
+                head = _head.load(std::memory_order_acquire);
+            }
+            _stats.stall_ns.record(elapsed_ns(start));
+        }
+        _limit = std::min<std::uint64_t>(head, (_pos | (_chunk - 1)) + 1);
+    }
+
+    void produce() {
+        std::uint64_t head = 0;
+        while (!_stop.load(std::memory_order_relaxed)) {
+            if (head - _tail.load(std::memory_order_acquire) + _chunk >
+                _capacity) {
+                _producer_waits.store(
+                    _producer_waits.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+                for (std::size_t round = 0;
+                     head - _tail.load(std::memory_order_acquire) + _chunk >
+                         _capacity &&
+                     !_stop.load(std::memory_order_relaxed);
+                     backoff(round)) {
+                }
+                continue;
+            }
+
+            const clock_type::time_point start = clock_type::now();
+            impl::fill_serial(_engine, _ring.get() + (head & _mask), _chunk);
+            head += _chunk;
+            _head.store(head, std::memory_order_release);
+
+            // chunks before the histogram, released: a reader acquiring
+            // the histogram first never sees more samples than chunks
+            const std::size_t bucket =
+                latency_histogram::bucket(elapsed_ns(start));
+            _chunks.store(_chunks.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+            _chunk_ns[bucket].store(
+                _chunk_ns[bucket].load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+        }
+    }
+
+    static std::uint64_t elapsed_ns(clock_type::time_point start) {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clock_type::now() - start)
+                .count());
+    }
+
+    // owned by the producer
+    Engine _engine;
+
+    const std::size_t _chunk, _capacity, _mask;
+    const std::unique_ptr<result_type[]> _ring;
+
+    // owned by the consumer
+    alignas(impl::cache_line_size) std::uint64_t _pos, _limit;
+    async_engine_stats _stats;
+
+    // values written, values consumed
+    alignas(impl::cache_line_size) std::atomic<std::uint64_t> _head;
+    alignas(impl::cache_line_size) std::atomic<std::uint64_t> _tail;
+
+    // set by the destructor, then the producer statistics
+    alignas(impl::cache_line_size) std::atomic<bool> _stop;
+    std::atomic<std::uint64_t> _producer_waits, _chunks;
+    std::array<std::atomic<std::uint64_t>, latency_histogram::n_buckets>
+        _chunk_ns;
+
+    std::thread _producer;
+};
+
+} // namespace alea
+
+#endif // _ALEA_ASYNC_ENGINE_HPP_
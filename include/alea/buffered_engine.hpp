@@ -0,0 +1,238 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_BUFFERED_ENGINE_HPP_
+#define _ALEA_BUFFERED_ENGINE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <iosfwd>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "counter_engine.hpp"
+#include "impl/cache_line.hpp"
+#include "impl/engine_fill.hpp"
+#include "jump.hpp"
+#include "random_derivate.hpp"
+
+///
+/// buffered_engine<Engine, NBlocks> draws the values of Engine from a
+/// cache line aligned buffer of NBlocks blocks, refilled in one bulk
+/// generate_n: the SIMD kernels of counter_engine encrypt all the blocks
+/// at once, operator() is a compare, a load and an increment
+///
+///    alea::buffered_engine<alea::counter_engine<alea::philox4x32>> engine(
+///        alea::counter_engine<alea::philox4x32>(42));
+///    std::normal_distribution<double> dist;
+///    double x = dist(engine);
+///
+/// The values, discard, derivate and operator== are the ones of the
+/// unbuffered engine at the same position: engine() gives it back.
+///
+/// The engine is kept at the start of the buffer and jumps over it at each
+/// refill, Engine must have a constant time jump ( has_constant_jump,
+/// counter_engine ): an O(n) discard would generate every value twice.
+///
+
+namespace alea {
+
+template <typename Engine, std::size_t NBlocks = 64> class buffered_engine {
+    static_assert(NBlocks > 0, "the buffer holds one block at least");
+    static_assert(has_constant_jump<Engine>::value,
+                  "buffered_engine requires an engine with a constant time "
+                  "jump");
+
+  public:
+    typedef Engine engine_type;
+    typedef typename Engine::result_type result_type;
+
+    /// number of values of the buffer
+    static constexpr std::size_t buffer_size =
+        NBlocks * impl::engine_block_size<Engine>::value;
+
+    buffered_engine() : _engine(), _pos(buffer_size), _filled(false) {}
+
+    explicit buffered_engine(const Engine &engine)
+        : _engine(engine), _pos(buffer_size), _filled(false) {}
+
+    /// seeded as Engine(args...)
+    template <typename Arg, typename = std::enable_if_t<!std::is_same<
+                                std::decay_t<Arg>, buffered_engine>::value &&
+                                                        !std::is_same<
+                                std::decay_t<Arg>, Engine>::value>>
+    explicit buffered_engine(Arg &&arg)
+        : _engine(std::forward<Arg>(arg)), _pos(buffer_size),
+          _filled(false) {}
+
+    template <typename... Args> void seed(Args &&...args) {
+        _engine.seed(std::forward<Args>(args)...);
+        _pos = buffer_size;
+        _filled = false;
+    }
+
+    static constexpr result_type min() { return Engine::min(); }
+
+    static constexpr result_type max() { return Engine::max(); }
+
+    result_type operator()() {
+        if (_pos == buffer_size) {
+            refill();
+        }
+        return _buffer[_pos++];
+    }
+
+    /// write the n next values to first, the buffered ones first and
+    /// the others straight from the engine
+    template <typename OutputIterator>
+    OutputIterator generate_n(OutputIterator first, std::size_t n) {
+        const std::size_t buffered = std::min(n, buffer_size - _pos);
+        first = std::copy(_buffer + _pos, _buffer + _pos + buffered, first);
+        _pos += buffered;
+        n -= buffered;
+
+        if (n >= buffer_size) {
+            drop_buffer();
+            const std::size_t direct = n - n % buffer_size;
+            impl::fill_serial(_engine, first, direct);
+            std::advance(first, direct);
+            n -= direct;
+        }
+        for (; n > 0; --n) {
+            *first++ = (*this)();
+        }
+        return first;
+    }
+
+    template <typename ForwardIterator>
+    void fill(ForwardIterator first, ForwardIterator last) {
+        (void)generate_n(first,
+                         static_cast<std::size_t>(std::distance(first, last)));
+    }
+
+    /// skip n values, in constant time, a negative n throws
+    /// std::invalid_argument
+    template <typename Integer>
+    typename std::enable_if<impl::is_jump_integer<Integer>::value>::type
+    discard(Integer n) {
+        typedef typename impl::is_jump_integer<Integer>::unsigned_type UInt;
+        impl::check_skip(n);
+
+        const std::size_t buffered = buffer_size - _pos;
+        if (static_cast<UInt>(n) <= buffered) {
+            _pos += static_cast<std::size_t>(n);
+            return;
+        }
+        drop_buffer();
+        _engine.discard(n);
+    }
+
+    /// the unbuffered engine at the same position
+    Engine engine() const {
+        Engine res(_engine);
+        if (_filled) {
+            res.discard(_pos);
+        }
+        return res;
+    }
+
+    /// buffered child of random_engine_derivate(engine(), key)
+    buffered_engine derivate(const result_type &key) const {
+        return buffered_engine(random_engine_derivate(engine(), key));
+    }
+
+    /// buffered child of engine().derivate(key), e.g. a counter_engine key
+    template <typename Key> buffered_engine derivate(const Key &key) const {
+        return buffered_engine(engine().derivate(key));
+    }
+
+    friend bool operator==(const buffered_engine &lhs,
+                           const buffered_engine &rhs) {
+        return lhs.engine() == rhs.engine();
+    }
+
+    friend bool operator!=(const buffered_engine &lhs,
+                           const buffered_engine &rhs) {
+        return !(lhs == rhs);
+    }
+
+    friend std::ostream &operator<<(std::ostream &os,
+                                    const buffered_engine &be) {
+        return os << be.engine();
+    }
+
+    friend std::istream &operator>>(std::istream &is, buffered_engine &be) {
+        Engine engine;
+        if (is >> engine) {
+            be = buffered_engine(engine);
+        }
+        return is;
+    }
+
+  private:
+    /// the engine moves over the consumed buffer, then computes the next
+    /// one from a copy so that it stays at the start of the buffer
+    void refill() {
+        if (_filled) {
+            _engine.discard(buffer_size);
+        }
+        Engine producer(_engine);
+        impl::fill_serial(producer, _buffer, buffer_size);
+        _pos = 0;
+        _filled = true;
+    }
+
+    /// move the engine to the current position and empty the buffer
+    void drop_buffer() {
+        if (_filled) {
+            _engine.discard(_pos);
+        }
+        _pos = buffer_size;
+        _filled = false;
+    }
+
+    /// at the first value of the buffer when _filled
+    Engine _engine;
+    std::size_t _pos;
+    bool _filled;
+    alignas(impl::cache_line_size) result_type _buffer[buffer_size];
+};
+
+// specialize random_engine_derivate
+// for buffered engines
+template <typename Engine, std::size_t NBlocks>
+inline buffered_engine<Engine, NBlocks> random_engine_derivate(
+    const buffered_engine<Engine, NBlocks> &engine,
+    const typename buffered_engine<Engine, NBlocks>::result_type &key) {
+    return engine.derivate(key);
+}
+
+} // namespace alea
+
+#endif // _ALEA_BUFFERED_ENGINE_HPP_
@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _ALEA_RANDOM_CHACHA_
+#define _ALEA_RANDOM_CHACHA_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "impl/simd_dispatch.hpp"
+#include "threefry.hpp"
+
+///
+///  chacha is the stream cipher of D. J. Bernstein used as
+///  a state-less counter based random generator
+///
+///  "ChaCha, a variant of Salsa20", D. J. Bernstein, 2008
+///
+///  The 512 bits block function maps a 256 bits key and the 128 bits
+///  of the state words 12 to 15 ( 64 bits block counter and 64 bits nonce
+///  in the original layout, 32 bits counter and 96 bits nonce in RFC 7539 )
+///  to 16 words of output, which makes it a cbrng with
+///      domain_type = 4 x 32 bits, range_type = 16 x 32 bits
+///
+///  chacha has a much larger cryptanalytic margin than the reduced round
+///  threefry and philox, chacha8 being the fastest reasonable choice
+///
+
+namespace alea {
+
+namespace impl {
+
+/// "expand 32-byte k"
+constexpr std::uint32_t chacha_constants[4] = {
+    UINT32_C(0x61707865), UINT32_C(0x3320646e), UINT32_C(0x79622d32),
+    UINT32_C(0x6b206574)};
+
+template <typename Word>
+ALEA_ALWAYS_INLINE inline void chacha_quarter_round(Word &a, Word &b, Word &c,
+                                                    Word &d) {
+    a += b;
+    d ^= a;
+    threefry_rotl<std::uint32_t>(d, 16);
+    c += d;
+    b ^= c;
+    threefry_rotl<std::uint32_t>(b, 12);
+    a += b;
+    d ^= a;
+    threefry_rotl<std::uint32_t>(d, 8);
+    c += d;
+    b ^= c;
+    threefry_rotl<std::uint32_t>(b, 7);
+}
+
+/// chacha double rounds ( one column round and one diagonal round )
+/// unrolled with the same recursive partial template specialization
+/// than the threefry rounds_functor
+///
+/// Word is either a 32 bits word or a vector of lanes
+template <unsigned r_remain, typename State> struct chacha_rounds_functor {
+    static_assert(r_remain % 2 == 0, "number of rounds should be even");
+
+    ALEA_ALWAYS_INLINE inline void operator()(State &x) {
+        chacha_quarter_round(x[0], x[4], x[8], x[12]);
+        chacha_quarter_round(x[1], x[5], x[9], x[13]);
+        chacha_quarter_round(x[2], x[6], x[10], x[14]);
+        chacha_quarter_round(x[3], x[7], x[11], x[15]);
+
+        chacha_quarter_round(x[0], x[5], x[10], x[15]);
+        chacha_quarter_round(x[1], x[6], x[11], x[12]);
+        chacha_quarter_round(x[2], x[7], x[8], x[13]);
+        chacha_quarter_round(x[3], x[4], x[9], x[14]);
+
+        chacha_rounds_functor<r_remain - 2, State> func;
+        func(x);
+    }
+};
+
+template <typename State> struct chacha_rounds_functor<0, State> {
+    ALEA_ALWAYS_INLINE inline void operator()(State &x) { (void)x; }
+};
+
+} // namespace impl
+
+template <unsigned R = 20> class chacha {
+    static_assert(R > 0 && R % 2 == 0, "number of rounds should be even");
+
+  public:
+    typedef utils::array<std::uint32_t, 4> domain_type;
+    typedef utils::array<std::uint32_t, 16> range_type;
+    typedef utils::array<std::uint32_t, 8> key_type;
+    typedef std::uint32_t uint_type;
+
+    explicit chacha() : k() {}
+    explicit chacha(key_type _k) : k(_k) {}
+
+    chacha(const chacha &) = default;
+    chacha(chacha &&) = default;
+
+    chacha &operator=(const chacha &) = default;
+    chacha &operator=(chacha &&) = default;
+
+    void set_key(key_type _k) { k = _k; }
+
+    key_type get_key() const { return k; }
+
+    bool operator==(const chacha &rhs) const { return k == rhs.k; }
+    bool operator!=(const chacha &rhs) const { return k != rhs.k; }
+
+    inline range_type operator()(const domain_type &counter) const {
+        const range_type input = state(counter);
+        range_type x(input);
+
+        impl::chacha_rounds_functor<R, range_type> func;
+        func(x);
+
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            x[i] += input[i];
+        }
+        return x;
+    }
+
+    /// encrypt the nblocks consecutive counters starting at counter
+    /// and write the 16 * nblocks output words to out
+    ///
+    /// uses the widest multi-lane kernel supported by the CPU
+    inline void operator()(const domain_type &counter, uint_type *out,
+                           std::size_t nblocks) const {
+        encrypt_blocks(impl::simd_isa_best(), counter, out, nblocks);
+    }
+
+    /// same as the bulk operator() with an explicit instruction set
+    void encrypt_blocks(impl::simd_isa isa, const domain_type &counter,
+                        uint_type *out, std::size_t nblocks) const;
+
+  private:
+    /// the 16 words input state: constants, key, counter
+    inline range_type state(const domain_type &counter) const {
+        range_type input;
+        std::copy_n(impl::chacha_constants, 4, input.begin());
+        std::copy(k.begin(), k.end(), input.begin() + 4);
+        std::copy(counter.begin(), counter.end(), input.begin() + 12);
+        return input;
+    }
+
+    key_type k;
+};
+
+typedef chacha<8> chacha8;
+typedef chacha<12> chacha12;
+typedef chacha<20> chacha20;
+
+} // namespace alea
+
+#include "impl/chacha_simd_impl.hpp"
+
+#endif // _ALEA_RANDOM_CHACHA_
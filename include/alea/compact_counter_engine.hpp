@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_COMPACT_COUNTER_ENGINE_HPP_
+#define _ALEA_COMPACT_COUNTER_ENGINE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "counter_engine.hpp"
+#include "impl/block_counter.hpp"
+
+///
+/// compact_counter_engine is a counter engine with a minimal state,
+/// meant to be used by millions of entities ( agents, particles, ... )
+/// that each need their own random stream
+///
+/// Instead of the key, counter and buffered block of counter_engine
+/// ( about 100 bytes for threefry4x64 ) it stores
+///  - a pointer to a cipher shared by all the entities
+///  - the stream id of the entity
+///  - the position in the stream
+/// which is 16 bytes with the default 32 bits Index.
+///
+/// The stream id is stored in the upper half of the counter bits and the
+/// block index in the lower half: the stream s of a compact_counter_engine
+/// is the same sequence than a counter_engine of the same key whose counter
+/// starts at s << ( counter bits / 2 ). Index must fit in the upper half
+/// below the domain field of the counter ( see impl/block_counter.hpp ).
+///
+/// No block is buffered: operator() computes a block for each value, the
+/// block functions ( generate_block, fill, generate_n ) should be preferred
+/// when several values are consumed at once
+///
+/// A stream holds the positions 0 to max of index_type, excluded: drawing
+/// or skipping past its end throws std::out_of_range, leaving the engine
+/// unchanged, instead of replaying the stream
+///
+/// The cipher must outlive the engines referencing it
+///
+
+namespace alea {
+
+template <typename CBRNG, typename Index = std::uint32_t>
+class compact_counter_engine {
+  public:
+    typedef CBRNG cbrng_type;
+    typedef typename CBRNG::domain_type ctr_type;
+    typedef typename CBRNG::range_type range_type;
+    typedef typename range_type::value_type result_type;
+    typedef Index index_type;
+
+    static_assert(std::is_unsigned<Index>::value,
+                  "the index type should be an unsigned integer");
+
+    // the stream ids fill the upper half of the counter below its domain
+    // field, the block indices the lower half without carrying into them
+    static_assert(impl::counter_bits<ctr_type>() / 2 +
+                          std::numeric_limits<Index>::digits <=
+                      impl::counter_bits<ctr_type>() -
+                          impl::counter_domain_bits<ctr_type>(),
+                  "the index type is too wide for the counter of the cbrng");
+
+    explicit compact_counter_engine() : cipher(nullptr), id(), pos() {}
+
+    explicit compact_counter_engine(const cbrng_type &shared_cipher,
+                                    index_type stream = 0)
+        : cipher(&shared_cipher), id(stream), pos() {}
+
+    compact_counter_engine(const compact_counter_engine &) = default;
+
+    compact_counter_engine &
+    operator=(const compact_counter_engine &) = default;
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    /// number of values per block
+    static constexpr std::size_t block_size() {
+        return std::tuple_size<range_type>::value;
+    }
+
+    /// next value, computes a full block
+    result_type operator()() {
+        check_remaining(1);
+        return at(pos++);
+    }
+
+    /// next block_size() values in the order returned by operator()
+    /// a single block is computed when the position is aligned on a block,
+    /// the two blocks it straddles otherwise
+    range_type generate_block() {
+        range_type block;
+        (void)generate_n(block.begin(), block_size());
+        return block;
+    }
+
+    /// fill [first, last) with the next values of the engine
+    template <typename ForwardIterator>
+    void fill(ForwardIterator first, ForwardIterator last) {
+        (void)generate_n(first, static_cast<std::size_t>(
+                                    std::distance(first, last)));
+    }
+
+    /// write the n next values of the engine to first,
+    /// computing each block once
+    template <typename OutputIterator>
+    OutputIterator generate_n(OutputIterator first, std::size_t n) {
+        check_remaining(n);
+        while (n > 0) {
+            const std::size_t lane = pos % block_size();
+            const std::size_t count = std::min(n, block_size() - lane);
+            const range_type block =
+                (*cipher)(block_counter(pos / block_size()));
+
+            for (std::size_t i = 0; i < count; ++i) {
+                *first++ = block[block_size() - 1 - lane - i];
+            }
+            pos += index_type(count);
+            n -= count;
+        }
+        return first;
+    }
+
+    /// skip the next skip values, see check_remaining
+    void discard(index_type skip) {
+        check_remaining(skip);
+        pos += skip;
+    }
+
+    /// value at the position index of the stream
+    result_type at(index_type index) const {
+        return (*cipher)(block_counter(index / block_size()))
+            [block_size() - 1 - index % block_size()];
+    }
+
+    index_type stream() const { return id; }
+
+    index_type position() const { return pos; }
+
+    const cbrng_type &get_cipher() const { return *cipher; }
+
+    /// equivalent counter_engine at the current position
+    counter_engine<cbrng_type> expand() const {
+        counter_engine<cbrng_type> res(cipher->get_key());
+        res.discard_blocks(stream_counter());
+        res.discard(pos);
+        return res;
+    }
+
+    friend bool operator==(const compact_counter_engine &lhs,
+                           const compact_counter_engine &rhs) {
+        return lhs.cipher == rhs.cipher && lhs.id == rhs.id &&
+               lhs.pos == rhs.pos;
+    }
+
+    friend bool operator!=(const compact_counter_engine &lhs,
+                           const compact_counter_engine &rhs) {
+        return !(lhs == rhs);
+    }
+
+  private:
+    /// throw std::out_of_range if the n next values run past the end
+    /// of the stream
+    void check_remaining(std::uintmax_t n) const {
+        if (n > std::uintmax_t(std::numeric_limits<index_type>::max() - pos)) {
+            throw std::out_of_range("compact_counter_engine out of the "
+                                    "range of its stream");
+        }
+    }
+
+    /// first counter of the stream: the stream id in the upper half
+    ctr_type stream_counter() const {
+        ctr_type ctr;
+        ctr.fill(typename ctr_type::value_type(0));
+        impl::counter_or_bits(ctr, impl::counter_bits<ctr_type>() / 2,
+                              std::uint64_t(id));
+        return ctr;
+    }
+
+    /// counter of the block of the given index in the stream
+    ctr_type block_counter(index_type block) const {
+        ctr_type ctr = stream_counter();
+        impl::counter_add(ctr, std::uint64_t(block) + 1);
+        return ctr;
+    }
+
+    const cbrng_type *cipher;
+    index_type id;
+    index_type pos;
+};
+
+} // namespace alea
+
+#endif // _ALEA_COMPACT_COUNTER_ENGINE_HPP_
@@ -32,11 +32,17 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <iterator>
 #include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "impl/block_counter.hpp"
+
 ///
 /// This work is inspired of algorithm
 ///  presented in the publication
@@ -51,30 +57,97 @@
 ///  counter_engine offers an interface compatible with both C++11 random engine
 ///  and Boost.Random
 ///
-///  available cbrng backend  are : threefy
+///  available cbrng backend  are : threefry, philox
 ///
 
 #include <random>
 
 namespace alea {
 
+namespace impl {
+
+template <typename CBRNG, typename = void>
+struct has_bulk_blocks : std::false_type {};
+
+/// true if CBRNG provides a bulk operator()(counter, out, nblocks)
+template <typename CBRNG>
+struct has_bulk_blocks<
+    CBRNG, std::void_t<decltype(std::declval<const CBRNG &>()(
+               std::declval<const typename CBRNG::domain_type &>(),
+               std::declval<typename CBRNG::uint_type *>(), std::size_t()))>>
+    : std::true_type {};
+
+/// throw std::out_of_range if a jump from the counter from to the counter
+/// to changes the domain field, see counter_domain_bits
+template <typename Ctr>
+inline void check_domain(const Ctr &from, const Ctr &to) {
+    if (counter_domain(from) != counter_domain(to)) {
+        throw std::out_of_range("jump out of the counter domain of the "
+                                "stream");
+    }
+}
+
+/// copy the words of from into an array of type To
+/// truncated or zero padded to the size of To
+template <typename To, typename From>
+inline To resize_array(const From &from) {
+    To res;
+    res.fill(typename To::value_type(0));
+    std::copy_n(from.begin(), std::min(from.size(), res.size()), res.begin());
+    return res;
+}
+
+/// encrypt the nblocks consecutive counters starting at counter into out
+/// using the bulk interface of the cbrng when available
+template <typename CBRNG>
+inline void cbrng_blocks(const CBRNG &b,
+                         const typename CBRNG::domain_type &counter,
+                         typename CBRNG::uint_type *out, std::size_t nblocks) {
+    if constexpr (has_bulk_blocks<CBRNG>::value) {
+        b(counter, out, nblocks);
+    } else {
+        typename CBRNG::domain_type ctr(counter);
+        for (; nblocks > 0; --nblocks) {
+            const typename CBRNG::range_type block = b(ctr);
+            out = std::copy(block.begin(), block.end(), out);
+
+            for (auto it = ctr.begin(); it != ctr.end() && ++(*it) == 0;
+                 ++it) {
+            }
+        }
+    }
+}
+
+} // namespace impl
+
 template <typename CBRNG> class counter_engine {
   public:
     typedef CBRNG cbrng_type;
     typedef typename CBRNG::domain_type ctr_type;
+    typedef typename CBRNG::range_type range_type;
     typedef typename CBRNG::key_type key_type;
-    typedef typename ctr_type::value_type result_type;
+    typedef typename range_type::value_type result_type;
     typedef size_t elem_type;
 
-    explicit counter_engine(const key_type &uk) : b(uk), c(), elem() {}
+    constexpr explicit counter_engine(const key_type &uk)
+        : b(uk), c(), elem(), v() {}
 
-    explicit counter_engine(key_type &uk) : b(uk), c(), elem() {}
+    constexpr explicit counter_engine(key_type &uk)
+        : b(uk), c(), elem(), v() {}
 
-    explicit counter_engine() : b(), c(), elem() {}
+    /// engine of key uk at the counter ctr: the next block is the one
+    /// of ctr + 1, counter_engine(uk) is counter_engine(uk, ctr_type{})
+    constexpr counter_engine(const key_type &uk, const ctr_type &ctr)
+        : b(uk), c(ctr), elem(), v() {}
 
-    explicit counter_engine(result_type r) : b(), c(), elem() {
-        key_type key;
-        std::fill(key.begin(), key.end(), typename key_type::value_type(r));
+    constexpr explicit counter_engine() : b(), c(), elem(), v() {}
+
+    constexpr explicit counter_engine(result_type r)
+        : b(), c(), elem(), v() {
+        key_type key{};
+        for (auto &word : key) {
+            word = typename key_type::value_type(r);
+        }
         b.set_key(key);
     }
 
@@ -115,9 +188,41 @@ template <typename CBRNG> class counter_engine {
         return lhs.c != rhs.c || lhs.elem != rhs.elem || lhs.b != rhs.b;
     }
 
+    /// write the counter words, the key words and the position in the
+    /// block, separated by spaces
     friend std::ostream &operator<<(std::ostream &os,
                                     const counter_engine &be) {
-        return os << be.c << " " << be.b.getkey() << " " << be.elem;
+        for (const auto &word : be.c) {
+            os << +word << " ";
+        }
+        for (const auto &word : be.b.get_key()) {
+            os << +word << " ";
+        }
+        return os << be.elem;
+    }
+
+    friend std::istream &operator>>(std::istream &is, counter_engine &be) {
+        ctr_type ctr;
+        key_type key;
+        elem_type elem;
+        for (auto &word : ctr) {
+            is >> word;
+        }
+        for (auto &word : key) {
+            is >> word;
+        }
+        is >> elem;
+        if (is && elem > std::tuple_size<range_type>::value) {
+            is.setstate(std::ios_base::failbit);
+        }
+        if (is) {
+            be = counter_engine(key, ctr);
+            if (elem > 0) {
+                be.v = be.b(ctr);
+                be.elem = elem;
+            }
+        }
+        return is;
     }
 
     const static result_type _min = 0;
@@ -127,38 +232,128 @@ template <typename CBRNG> class counter_engine {
 
     static constexpr result_type max() { return _max; }
 
-    result_type operator()() {
+    /// constexpr with the cbrng that support it ( threefry ): a table
+    /// of random values can be computed at compile time and matches
+    /// the runtime stream of the same key
+    constexpr result_type operator()() {
         if (elem == 0) {
-            incr_array(c.begin(), c.end());
+            impl::counter_increment(c);
             v = b(c);
-            elem = c.size();
+            elem = v.size();
         }
         return v[--elem];
     }
 
-    result_type generate() { return (*this)(); }
+    constexpr result_type generate() { return (*this)(); }
 
-    ctr_type generate_block() {
+    constexpr range_type generate_block() {
         elem = 0;
-        incr_array(c.begin(), c.end());
+        impl::counter_increment(c);
         return b(c);
     }
 
-    void discard(std::uintmax_t skip) {
-        // any buffered turn need to be dropped
-        while (elem != 0 && skip > 0) {
-            skip--;
-            elem--;
+    /// fill [first, last) with the next values of the engine
+    ///
+    /// equivalent to std::generate(first, last, std::ref(*this)),
+    /// see generate_n
+    template <typename ForwardIterator>
+    void fill(ForwardIterator first, ForwardIterator last) {
+        (void)generate_n(first, static_cast<std::size_t>(
+                                    std::distance(first, last)));
+    }
+
+    /// write the n next values of the engine to first
+    ///
+    /// The output and the final engine state are the same than
+    /// n calls to operator(), but the full blocks are encrypted in bulk
+    /// ( SIMD kernels ) directly into the destination when it is a
+    /// result_type pointer, without going through the buffered block
+    template <typename OutputIterator>
+    OutputIterator generate_n(OutputIterator first, std::size_t n) {
+        // drain the buffered block first
+        for (; elem != 0 && n > 0; --n) {
+            *first++ = v[--elem];
         }
-        const size_t nelem = c.size();
-        std::uintmax_t counter_increment = skip / nelem;
-        std::uintmax_t counter_rest = skip % nelem;
-        incr_array(c.begin(), c.end(), counter_increment);
-
-        // call generator for remaining turns
-        while (counter_rest--) {
-            (void)(*this)();
+
+        const std::size_t nelem = v.size();
+        const std::size_t nblocks = n / nelem;
+        first = generate_blocks(first, nblocks);
+        n -= nblocks * nelem;
+
+        // remaining values start a new buffered block
+        for (; n > 0; --n) {
+            *first++ = (*this)();
         }
+        return first;
+    }
+
+    /// skip the next skip values in constant time
+    ///
+    /// skip can be any integer type, including __uint128_t, a negative
+    /// skip throws std::invalid_argument and a skip reaching the domain
+    /// field of the counter std::out_of_range, leaving the engine
+    /// unchanged. At most one block is computed, to refill the buffered
+    /// block
+    template <typename Integer>
+    typename std::enable_if<impl::is_jump_integer<Integer>::value>::type
+    discard(Integer n) {
+        typedef typename impl::is_jump_integer<Integer>::unsigned_type UInt;
+        impl::check_skip(n);
+        UInt skip = static_cast<UInt>(n);
+
+        // consume the buffered block first
+        if (skip <= elem) {
+            elem -= static_cast<elem_type>(skip);
+            return;
+        }
+        skip -= elem;
+
+        const std::size_t nelem = v.size();
+        ctr_type to(c);
+        impl::counter_add(to, UInt(skip / nelem));
+        impl::check_domain(c, to);
+        c = to;
+        elem = 0;
+
+        const std::size_t rest = static_cast<std::size_t>(skip % nelem);
+        if (rest != 0) {
+            refill_block(nelem - rest);
+        }
+    }
+
+    /// skip nblocks full blocks: nblocks * block size values
+    ///
+    /// nblocks spans the counter up to its domain field, which allows
+    /// to jump between substreams encoded in the upper counter words.
+    /// A jump changing the domain field throws std::out_of_range and
+    /// leaves the engine unchanged
+    void discard_blocks(const ctr_type &nblocks) {
+        ctr_type to(c);
+        impl::counter_add(to, nblocks);
+        impl::check_domain(c, to);
+        c = to;
+        if (elem != 0) {
+            v = b(c);
+        }
+    }
+
+    template <typename C>
+    friend impl::counter_wide_uint distance(const counter_engine<C> &a,
+                                            const counter_engine<C> &b);
+
+    /// value at the position index of the stream of the engine key,
+    /// the position 0 being the first value after seeding
+    ///
+    /// at(i) does not depend on the state of the engine and computes
+    /// a single block
+    constexpr result_type at(std::uint64_t index) const {
+        const std::size_t nelem = std::tuple_size<range_type>::value;
+
+        ctr_type ctr{};
+        impl::counter_add(ctr, index / nelem);
+        impl::counter_increment(ctr);
+
+        return b(ctr)[nelem - 1 - index % nelem];
     }
 
     counter_engine<cbrng_type> derivate(const key_type &key) const {
@@ -184,7 +379,11 @@ template <typename CBRNG> class counter_engine {
                     derivate_counter.v.end());
 
         // and using previous rotate generated block as element
-        key_type new_key = derivate_counter.b(derivate_counter.v);
+        // blocks, counters and keys can have different sizes
+        // ( e.g philox, chacha )
+        const range_type new_key_block = derivate_counter.b(
+            impl::resize_array<ctr_type>(derivate_counter.v));
+        const key_type new_key = impl::resize_array<key_type>(new_key_block);
         // use the new key as counter
         derivate_counter.seed(new_key);
 
@@ -197,60 +396,128 @@ template <typename CBRNG> class counter_engine {
         return derivate(key);
     }
 
-    ctr_type operator()(const ctr_type &c) const { return b(c); }
+    constexpr range_type operator()(const ctr_type &c) const { return b(c); }
 
-    key_type getseed() const { return c.get_key(); }
+    key_type getseed() const { return b.get_key(); }
 
     ctr_type getcounter() const { return c; }
 
   private:
-    template <typename Iterator>
-    inline void incr_array(Iterator start, Iterator finish) {
-        static const typename cbrng_type::uint_type max_elem =
-            std::numeric_limits<typename cbrng_type::uint_type>::max();
-
-        while (start != finish) {
-            if (*start == max_elem) {
-                *start = 0;
-                start++;
-            } else {
-                *start += 1;
-                break;
+    /// write the nblocks next full blocks to first
+    /// in the order operator() would return their elements
+    template <typename OutputIterator>
+    OutputIterator generate_blocks(OutputIterator first,
+                                   std::size_t nblocks) {
+        const std::size_t nelem = v.size();
+        ctr_type start(c);
+        impl::counter_increment(start);
+        impl::counter_add(c, nblocks);
+
+        if constexpr (std::is_same<OutputIterator, result_type *>::value) {
+            impl::cbrng_blocks(b, start, first, nblocks);
+            for (std::size_t i = 0; i < nblocks; ++i, first += nelem) {
+                std::reverse(first, first + nelem);
             }
+            return first;
+        } else {
+            constexpr std::size_t chunk_blocks = 64;
+            result_type
+                buffer[chunk_blocks * std::tuple_size<range_type>::value];
+
+            while (nblocks > 0) {
+                const std::size_t n = std::min(nblocks, chunk_blocks);
+                first = generate_blocks(first, buffer, start, n);
+                impl::counter_add(start, n);
+                nblocks -= n;
+            }
+            return first;
         }
     }
 
-    template <typename Iterator>
-    void incr_array(Iterator start, Iterator finish, std::uintmax_t inc_val) {
-        static const typename cbrng_type::uint_type max_elem =
-            std::numeric_limits<typename cbrng_type::uint_type>::max();
-
-        if (inc_val == 0 || start == finish) {
-            return;
+    template <typename OutputIterator>
+    OutputIterator generate_blocks(OutputIterator first, result_type *buffer,
+                                   const ctr_type &start,
+                                   std::size_t nblocks) const {
+        const std::size_t nelem = v.size();
+        impl::cbrng_blocks(b, start, buffer, nblocks);
+        for (std::size_t i = 0; i < nblocks; ++i) {
+            first = std::reverse_copy(buffer + i * nelem,
+                                      buffer + (i + 1) * nelem, first);
         }
+        return first;
+    }
 
-        std::uintmax_t current_inc_val = inc_val & max_elem;
-        const std::uintmax_t next_inc_val =
-            ((sizeof(std::uintmax_t) != sizeof(typename cbrng_type::uint_type))
-                 ? (inc_val >> (sizeof(max_elem) * 8))
-                 : 0);
-
-        const typename cbrng_type::uint_type past_val = *start;
-        *start += current_inc_val;
-
-        if (*start < past_val) { // overflow occured, inc +1 next elem
-            incr_array(start + 1, finish, next_inc_val + 1);
-        } else {
-            incr_array(start + 1, finish, next_inc_val);
-        }
+    /// move to the next block and buffer it with remaining
+    /// values left to consume
+    void refill_block(elem_type remaining) {
+        impl::counter_increment(c);
+        v = b(c);
+        elem = remaining;
     }
 
     cbrng_type b;
     ctr_type c;
     elem_type elem;
-    ctr_type v;
+    range_type v;
 };
 
+/// number of values to generate from a to reach the state of b
+///
+/// throw std::invalid_argument if the engines have different keys
+/// or if b is behind a, std::overflow_error if the distance does
+/// not fit in impl::counter_wide_uint
+template <typename CBRNG>
+inline impl::counter_wide_uint distance(const counter_engine<CBRNG> &a,
+                                        const counter_engine<CBRNG> &b) {
+    typedef typename counter_engine<CBRNG>::ctr_type ctr_type;
+
+    if (a.b != b.b) {
+        throw std::invalid_argument(
+            "distance between engines of different keys");
+    }
+
+    ctr_type blocks;
+    if (impl::counter_sub(b.c, a.c, blocks)) {
+        throw std::invalid_argument(
+            "distance to an engine behind the first one");
+    }
+
+    // blocks * nelem + a.elem - b.elem
+    constexpr unsigned digits =
+        std::numeric_limits<typename ctr_type::value_type>::digits;
+    constexpr unsigned wide_digits =
+        impl::counter_digits<impl::counter_wide_uint>();
+    const impl::counter_wide_uint nelem = a.v.size();
+    const impl::counter_wide_uint max_wide = ~impl::counter_wide_uint(0);
+
+    impl::counter_wide_uint res = 0;
+    for (std::size_t w = 0; w < blocks.size(); ++w) {
+        if (blocks[w] == 0) {
+            continue;
+        }
+        if (w * digits >= wide_digits) {
+            throw std::overflow_error("engine distance overflow");
+        }
+        const impl::counter_wide_uint word = blocks[w];
+        const unsigned shift = unsigned(w * digits);
+        if ((word << shift) >> shift != word) {
+            throw std::overflow_error("engine distance overflow");
+        }
+        res += word << shift;
+    }
+
+    if (res > (max_wide - a.elem) / nelem) {
+        throw std::overflow_error("engine distance overflow");
+    }
+    res = res * nelem + a.elem;
+
+    if (res < b.elem) {
+        throw std::invalid_argument(
+            "distance to an engine behind the first one");
+    }
+    return res - b.elem;
+}
+
 // specialize random_engine_derivate
 // for counter base random generator
 template <typename CBRNG>
@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_AES_SOFT_HPP_
+#define _ALEA_AES_SOFT_HPP_
+
+#include <array>
+#include <cstdint>
+
+///
+/// portable software implementation of the AES rounds
+/// with the semantic of the AES-NI aesenc / aesenclast instructions
+///
+/// The state is 4 little endian 32 bits words, word c holding the
+/// column c of the AES state ( same memory layout than a __m128i )
+///
+/// The implementation uses the classic 32 bits "T-table" formulation,
+/// the tables are generated at compile time from the definition of the
+/// AES S-box. It is not constant time: it is meant to be used by
+/// random generators, not for cryptography
+///
+
+namespace alea {
+
+namespace impl {
+
+typedef std::array<std::uint32_t, 4> aes_block;
+
+struct aes_soft_tables {
+    std::uint8_t sbox[256];
+    // SubBytes + MixColumns of a byte of the row 0
+    std::uint32_t mix[256];
+};
+
+constexpr std::uint8_t aes_xtime(std::uint8_t x) {
+    return std::uint8_t((x << 1) ^ ((x & 0x80) ? 0x1b : 0));
+}
+
+constexpr std::uint8_t aes_gmul(std::uint8_t a, std::uint8_t b) {
+    std::uint8_t res = 0;
+    for (; b != 0; b >>= 1, a = aes_xtime(a)) {
+        if (b & 1) {
+            res ^= a;
+        }
+    }
+    return res;
+}
+
+constexpr std::uint8_t aes_rotl8(std::uint8_t x, unsigned s) {
+    return std::uint8_t((x << s) | (x >> (8 - s)));
+}
+
+constexpr aes_soft_tables aes_make_soft_tables() {
+    aes_soft_tables tables{};
+    for (unsigned x = 0; x < 256; ++x) {
+        // multiplicative inverse in GF(2^8) as x^254, 0 maps to 0
+        std::uint8_t inv = 1, square = std::uint8_t(x);
+        for (unsigned e = 254; e != 0; e >>= 1) {
+            if (e & 1) {
+                inv = aes_gmul(inv, square);
+            }
+            square = aes_gmul(square, square);
+        }
+
+        const std::uint8_t s = inv ^ aes_rotl8(inv, 1) ^ aes_rotl8(inv, 2) ^
+                               aes_rotl8(inv, 3) ^ aes_rotl8(inv, 4) ^ 0x63;
+        tables.sbox[x] = s;
+        tables.mix[x] = std::uint32_t(aes_gmul(s, 2)) |
+                        std::uint32_t(s) << 8 | std::uint32_t(s) << 16 |
+                        std::uint32_t(aes_gmul(s, 3)) << 24;
+    }
+    return tables;
+}
+
+inline constexpr aes_soft_tables aes_tables = aes_make_soft_tables();
+
+constexpr std::uint32_t aes_byte(std::uint32_t w, unsigned row) {
+    return (w >> (8 * row)) & 0xff;
+}
+
+constexpr std::uint32_t aes_rotl32(std::uint32_t w, unsigned s) {
+    return (s == 0) ? w : ((w << s) | (w >> (32 - s)));
+}
+
+/// ShiftRows, SubBytes, MixColumns and AddRoundKey ( aesenc )
+inline aes_block aes_soft_round(const aes_block &state,
+                                const aes_block &round_key) {
+    aes_block res;
+    for (unsigned c = 0; c < 4; ++c) {
+        std::uint32_t col = round_key[c];
+        for (unsigned row = 0; row < 4; ++row) {
+            col ^= aes_rotl32(
+                aes_tables.mix[aes_byte(state[(c + row) % 4], row)], 8 * row);
+        }
+        res[c] = col;
+    }
+    return res;
+}
+
+/// ShiftRows, SubBytes and AddRoundKey ( aesenclast )
+inline aes_block aes_soft_last_round(const aes_block &state,
+                                     const aes_block &round_key) {
+    aes_block res;
+    for (unsigned c = 0; c < 4; ++c) {
+        std::uint32_t col = round_key[c];
+        for (unsigned row = 0; row < 4; ++row) {
+            col ^= std::uint32_t(
+                       aes_tables.sbox[aes_byte(state[(c + row) % 4], row)])
+                   << (8 * row);
+        }
+        res[c] = col;
+    }
+    return res;
+}
+
+} // namespace impl
+
+} // namespace alea
+
+#endif // _ALEA_AES_SOFT_HPP_
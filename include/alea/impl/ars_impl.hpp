@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_ARS_IMPL_HPP_
+#define _ALEA_ARS_IMPL_HPP_
+
+#include "../ars.hpp"
+#include "aes_soft.hpp"
+#include "block_counter.hpp"
+#include "simd_dispatch.hpp"
+
+#ifdef ALEA_SIMD_X86
+#include <immintrin.h>
+#endif
+
+///
+/// ars block kernels
+///
+/// The AES-NI kernel interleaves the rounds of 8 consecutive counters
+/// to hide the latency of the aesenc instruction
+///
+
+namespace alea {
+
+namespace impl {
+
+/// encrypt the nblocks counters ctr, ctr + 1, ... where the first
+/// counter word does not wrap around
+template <unsigned R>
+inline void ars_run_soft(const std::array<aes_block, R + 1> &rk,
+                         const aes_block &ctr, std::uint32_t *out,
+                         std::size_t nblocks) {
+    for (std::size_t i = 0; i < nblocks; ++i, out += 4) {
+        aes_block v;
+        for (unsigned w = 0; w < 4; ++w) {
+            v[w] = ctr[w] ^ rk[0][w];
+        }
+        v[0] = std::uint32_t(ctr[0] + std::uint32_t(i)) ^ rk[0][0];
+
+        for (unsigned r = 1; r < R; ++r) {
+            v = aes_soft_round(v, rk[r]);
+        }
+        v = aes_soft_last_round(v, rk[R]);
+
+        for (unsigned w = 0; w < 4; ++w) {
+            out[w] = v[w];
+        }
+    }
+}
+
+#ifdef ALEA_SIMD_X86
+
+/// same as ars_run_soft with the AES-NI instructions
+template <unsigned R>
+ALEA_TARGET_AES inline void
+ars_run_aesni(const std::array<aes_block, R + 1> &rk, const aes_block &ctr,
+              std::uint32_t *out, std::size_t nblocks) {
+    constexpr unsigned interleave = 8;
+
+    __m128i round_keys[R + 1];
+    for (unsigned r = 0; r <= R; ++r) {
+        round_keys[r] =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(rk[r].data()));
+    }
+    const __m128i start =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctr.data()));
+
+    std::size_t i = 0;
+    for (; i + interleave <= nblocks; i += interleave) {
+        __m128i v[interleave];
+        for (unsigned l = 0; l < interleave; ++l) {
+            v[l] = _mm_add_epi32(start, _mm_set_epi32(0, 0, 0, int(i + l)));
+            v[l] = _mm_xor_si128(v[l], round_keys[0]);
+        }
+        for (unsigned r = 1; r < R; ++r) {
+            for (unsigned l = 0; l < interleave; ++l) {
+                v[l] = _mm_aesenc_si128(v[l], round_keys[r]);
+            }
+        }
+        for (unsigned l = 0; l < interleave; ++l) {
+            v[l] = _mm_aesenclast_si128(v[l], round_keys[R]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4 * (i + l)),
+                             v[l]);
+        }
+    }
+
+    for (; i < nblocks; ++i) {
+        __m128i v = _mm_add_epi32(start, _mm_set_epi32(0, 0, 0, int(i)));
+        v = _mm_xor_si128(v, round_keys[0]);
+        for (unsigned r = 1; r < R; ++r) {
+            v = _mm_aesenc_si128(v, round_keys[r]);
+        }
+        v = _mm_aesenclast_si128(v, round_keys[R]);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4 * i), v);
+    }
+}
+
+#endif
+
+} // namespace impl
+
+template <unsigned R>
+inline std::array<impl::aes_block, R + 1> ars<R>::round_keys() const {
+    std::array<impl::aes_block, R + 1> rk;
+
+    std::uint64_t lo = std::uint64_t(k[0]) | std::uint64_t(k[1]) << 32;
+    std::uint64_t hi = std::uint64_t(k[2]) | std::uint64_t(k[3]) << 32;
+    for (unsigned r = 0; r <= R; ++r) {
+        rk[r] = {{std::uint32_t(lo), std::uint32_t(lo >> 32), std::uint32_t(hi),
+                  std::uint32_t(hi >> 32)}};
+        lo += impl::ars_weyl[0];
+        hi += impl::ars_weyl[1];
+    }
+    return rk;
+}
+
+template <unsigned R>
+inline void ars<R>::encrypt_blocks(impl::aes_impl aes,
+                                   const domain_type &counter,
+                                   uint_type *out,
+                                   std::size_t nblocks) const {
+    const std::array<impl::aes_block, R + 1> rk = round_keys();
+    domain_type ctr(counter);
+
+    while (nblocks > 0) {
+        const std::size_t run = impl::counter_run(ctr, nblocks);
+        const impl::aes_block start = {{ctr[0], ctr[1], ctr[2], ctr[3]}};
+
+        switch (aes) {
+#ifdef ALEA_SIMD_X86
+        case impl::aes_impl::aes_ni:
+            impl::ars_run_aesni<R>(rk, start, out, run);
+            break;
+#endif
+        default:
+            impl::ars_run_soft<R>(rk, start, out, run);
+        }
+
+        impl::counter_add(ctr, run);
+        out += run * 4;
+        nblocks -= run;
+    }
+}
+
+} // namespace alea
+
+#endif // _ALEA_ARS_IMPL_HPP_
@@ -0,0 +1,245 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_BLOCK_COUNTER_HPP_
+#define _ALEA_BLOCK_COUNTER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+///
+/// multi-word counter arithmetic shared by the bulk block kernels
+/// of the counter based generators
+///
+/// counters are little endian: word 0 is the least significant one,
+/// as for the counter_engine increments
+///
+
+namespace alea {
+
+namespace impl {
+
+#ifdef __SIZEOF_INT128__
+/// widest unsigned integer usable for jumps and distances
+typedef __uint128_t counter_wide_uint;
+#else
+typedef std::uintmax_t counter_wide_uint;
+#endif
+
+/// number of bits of the integer types accepted by counter_add
+template <typename UInt> constexpr unsigned counter_digits() {
+#ifdef __SIZEOF_INT128__
+    if constexpr (std::is_same<UInt, __uint128_t>::value) {
+        return 128;
+    }
+#endif
+    return unsigned(std::numeric_limits<UInt>::digits);
+}
+
+template <typename Integer, typename = void>
+struct is_jump_integer : std::false_type {};
+
+/// integer types accepted by the engines discard and by alea::jump
+template <typename Integer>
+struct is_jump_integer<
+    Integer, typename std::enable_if<std::is_integral<Integer>::value &&
+                                     !std::is_same<Integer, bool>::value>::type>
+    : std::true_type {
+    typedef typename std::make_unsigned<Integer>::type unsigned_type;
+};
+
+#ifdef __SIZEOF_INT128__
+template <> struct is_jump_integer<__uint128_t> : std::true_type {
+    typedef __uint128_t unsigned_type;
+};
+#endif
+
+/// throw std::invalid_argument if the skip n of a discard or a jump is
+/// negative, which would otherwise be a huge forward jump
+template <typename Integer> inline void check_skip(Integer n) {
+    if constexpr (std::is_signed<Integer>::value) {
+        if (n < 0) {
+            throw std::invalid_argument("skip of a negative number of values");
+        }
+    }
+}
+
+/// increment a multi-word counter by one
+template <typename Uint, std::size_t N>
+constexpr void counter_increment(std::array<Uint, N> &c) {
+    for (std::size_t w = 0; w < N && ++c[w] == 0; ++w) {
+    }
+}
+
+/// add the unsigned integer inc to a multi-word counter,
+/// least significant word first, modulo 2^(N * digits)
+template <typename Uint, std::size_t N, typename UInt>
+constexpr void counter_add(std::array<Uint, N> &c, UInt inc) {
+    constexpr unsigned digits = std::numeric_limits<Uint>::digits;
+
+    Uint carry = 0;
+    for (std::size_t w = 0; w < N && (inc != 0 || carry != 0); ++w) {
+        const Uint word = Uint(inc);
+        const Uint sum = c[w] + word;
+        const Uint sum_carry = sum + carry;
+        carry = Uint((sum < word) || (sum_carry < sum));
+        c[w] = sum_carry;
+
+        if constexpr (digits < counter_digits<UInt>()) {
+            inc >>= digits;
+        } else {
+            inc = 0;
+        }
+    }
+}
+
+/// add the multi-word integer inc to a multi-word counter
+/// modulo 2^(N * digits)
+template <typename Uint, std::size_t N>
+constexpr void counter_add(std::array<Uint, N> &c,
+                        const std::array<Uint, N> &inc) {
+    Uint carry = 0;
+    for (std::size_t w = 0; w < N; ++w) {
+        const Uint sum = c[w] + inc[w];
+        const Uint sum_carry = sum + carry;
+        carry = Uint((sum < inc[w]) || (sum_carry < sum));
+        c[w] = sum_carry;
+    }
+}
+
+/// res = a - b on multi-word integers,
+/// return true if the subtraction borrowed ( a < b )
+template <typename Uint, std::size_t N>
+inline bool counter_sub(const std::array<Uint, N> &a,
+                        const std::array<Uint, N> &b,
+                        std::array<Uint, N> &res) {
+    Uint borrow = 0;
+    for (std::size_t w = 0; w < N; ++w) {
+        const Uint diff = a[w] - b[w];
+        res[w] = diff - borrow;
+        borrow = Uint((a[w] < b[w]) || (diff < borrow));
+    }
+    return borrow != 0;
+}
+
+/// or the bits of value into a multi-word counter, starting at the bit
+/// offset, the bits beyond the counter width are dropped
+template <typename Uint, std::size_t N>
+inline void counter_or_bits(std::array<Uint, N> &c, std::size_t offset,
+                            std::uint64_t value) {
+    constexpr std::size_t digits = std::numeric_limits<Uint>::digits;
+
+    for (std::size_t w = 0; w < N; ++w) {
+        const std::size_t low = w * digits;
+        if (low + digits <= offset || low >= offset + 64) {
+            continue;
+        }
+        c[w] |= (low >= offset) ? Uint(value >> (low - offset))
+                                : Uint(value << (offset - low));
+    }
+}
+
+/// number of bits of the counter type Ctr
+template <typename Ctr> constexpr std::size_t counter_bits() {
+    return std::tuple_size<Ctr>::value *
+           std::size_t(std::numeric_limits<typename Ctr::value_type>::digits);
+}
+
+/// width of the domain field of the counters of type Ctr
+///
+/// The most significant byte of the counters of 128 bits or more is a
+/// domain tag keeping apart the counter regions used by the library for
+/// a given key ( see the counter_domain_* values ). Nothing else may
+/// write in this byte: the counter_engine stream of a key and the
+/// compact_counter_engine streams live in the domain 0, and the jumps of
+/// counter_engine can not leave the domain of the engine.
+///
+/// Smaller counters have no room for it and no domain field.
+template <typename Ctr> constexpr std::size_t counter_domain_bits() {
+    return counter_bits<Ctr>() >= 128 ? 8 : 0;
+}
+
+/// counter_engine and compact_counter_engine streams
+constexpr std::uint64_t counter_domain_stream = 0;
+/// split of the key API
+constexpr std::uint64_t counter_domain_split = 1;
+/// fold_in of the key API
+constexpr std::uint64_t counter_domain_fold_in = 2;
+/// random_bits of the key API
+constexpr std::uint64_t counter_domain_random_bits = 3;
+/// monte_carlo sample regions
+constexpr std::uint64_t counter_domain_monte_carlo = 4;
+
+/// set the domain field of a counter, which must have one
+template <typename Uint, std::size_t N>
+inline void counter_set_domain(std::array<Uint, N> &c, std::uint64_t domain) {
+    typedef std::array<Uint, N> ctr_type;
+    static_assert(counter_domain_bits<ctr_type>() != 0,
+                  "the counter is too small for a domain field");
+
+    counter_or_bits(c, counter_bits<ctr_type>() - 8, domain);
+}
+
+/// domain field of a counter, 0 for the counters without one
+template <typename Uint, std::size_t N>
+constexpr std::uint64_t counter_domain(const std::array<Uint, N> &c) {
+    typedef std::array<Uint, N> ctr_type;
+    if constexpr (counter_domain_bits<ctr_type>() == 0) {
+        return 0;
+    } else {
+        return std::uint64_t(c[N - 1] >>
+                             (std::numeric_limits<Uint>::digits - 8));
+    }
+}
+
+/// number of blocks, at most nblocks, that can be generated from ctr
+/// before its least significant word wraps around
+///
+/// Inside such a run only the first counter word changes, the kernels
+/// rely on it to keep the counter in registers
+template <typename Uint, std::size_t N>
+inline std::size_t counter_run(const std::array<Uint, N> &ctr,
+                               std::size_t nblocks) {
+    const Uint remaining = std::numeric_limits<Uint>::max() - ctr[0];
+    if (static_cast<std::uintmax_t>(remaining) <
+        static_cast<std::uintmax_t>(nblocks - 1)) {
+        return static_cast<std::size_t>(remaining) + 1;
+    }
+    return nblocks;
+}
+
+} // namespace impl
+
+} // namespace alea
+
+#endif // _ALEA_BLOCK_COUNTER_HPP_
@@ -0,0 +1,259 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_CHACHA_SIMD_IMPL_HPP_
+#define _ALEA_CHACHA_SIMD_IMPL_HPP_
+
+#include <cstring>
+#include <utility>
+
+#include "../chacha.hpp"
+#include "block_counter.hpp"
+#include "simd_dispatch.hpp"
+
+///
+/// multi-lane chacha kernels
+///
+/// As for threefry, Lanes consecutive blocks are computed at once with
+/// word w of all the blocks in a single vector register. Only the state
+/// word 12 ( the low word of the counter ) differs between the lanes.
+///
+/// SSE2 computes 4 blocks per iteration, AVX2 8 blocks and AVX-512 16 blocks
+///
+/// When the compiler provides __builtin_shufflevector the output is
+/// transposed back to the block layout with 4x4 word shuffles
+/// inside each 128 bits chunk, and stored 4 words at a time
+///
+
+namespace alea {
+
+namespace impl {
+
+/// compute the nblocks blocks of the input states
+/// input, input + 1, ... on word 12, without wrap around of this word
+template <unsigned R>
+inline void chacha_run_scalar(const utils::array<std::uint32_t, 16> &input,
+                              std::uint32_t *out, std::size_t nblocks) {
+    typedef utils::array<std::uint32_t, 16> state_type;
+
+    for (std::size_t i = 0; i < nblocks; ++i, out += 16) {
+        state_type start(input);
+        start[12] += std::uint32_t(i);
+        state_type x(start);
+
+        chacha_rounds_functor<R, state_type> func;
+        func(x);
+
+        for (unsigned w = 0; w < 16; ++w) {
+            out[w] = x[w] + start[w];
+        }
+    }
+}
+
+#ifdef ALEA_SIMD_X86
+
+#ifdef ALEA_HAS_SHUFFLEVECTOR
+
+/// index of the element i of the interleave of two vectors of Lanes
+/// 32 bits words, in each 128 bits chunk:
+///  Width 1 : a0 b0 a1 b1 ( unpacklo_epi32 )
+///  Width 2 : a0 a1 b0 b1 ( unpacklo_epi64 )
+/// High selects the upper half of the chunk ( unpackhi )
+constexpr int chacha_interleave_index(std::size_t i, std::size_t lanes,
+                                      unsigned width, bool high) {
+    return int((((i % 4) / width) % 2 ? lanes : 0) + (i / 4) * 4 +
+               ((i % 4) % width) + (((i % 4) / (2 * width)) * width) +
+               (high ? 2 : 0));
+}
+
+template <unsigned Width, bool High, typename Vector, std::size_t... I>
+ALEA_ALWAYS_INLINE inline void
+chacha_interleave(Vector &res, const Vector &a, const Vector &b,
+                  std::index_sequence<I...>) {
+    res = __builtin_shufflevector(
+        a, b, chacha_interleave_index(I, sizeof...(I), Width, High)...);
+}
+
+/// store the 16 state words of Lanes blocks in the block layout
+template <unsigned Lanes, typename Vector>
+ALEA_ALWAYS_INLINE inline void
+chacha_store_lanes(const utils::array<Vector, 16> &x, std::uint32_t *out) {
+    typedef std::make_index_sequence<Lanes> indices;
+
+    for (unsigned g = 0; g < 4; ++g) {
+        Vector t[4], r[4];
+        chacha_interleave<1, false>(t[0], x[4 * g], x[4 * g + 1], indices());
+        chacha_interleave<1, true>(t[1], x[4 * g], x[4 * g + 1], indices());
+        chacha_interleave<1, false>(t[2], x[4 * g + 2], x[4 * g + 3],
+                                    indices());
+        chacha_interleave<1, true>(t[3], x[4 * g + 2], x[4 * g + 3],
+                                   indices());
+
+        chacha_interleave<2, false>(r[0], t[0], t[2], indices());
+        chacha_interleave<2, true>(r[1], t[0], t[2], indices());
+        chacha_interleave<2, false>(r[2], t[1], t[3], indices());
+        chacha_interleave<2, true>(r[3], t[1], t[3], indices());
+
+        // chunk j of r[k] holds the words 4g to 4g + 3 of the lane 4j + k
+        for (unsigned j = 0; j < Lanes / 4; ++j) {
+            for (unsigned k = 0; k < 4; ++k) {
+                std::memcpy(out + (4 * j + k) * 16 + 4 * g,
+                            reinterpret_cast<const std::uint32_t *>(&r[k]) +
+                                4 * j,
+                            4 * sizeof(std::uint32_t));
+            }
+        }
+    }
+}
+
+#else
+
+/// store the 16 state words of Lanes blocks in the block layout
+template <unsigned Lanes, typename Vector>
+ALEA_ALWAYS_INLINE inline void
+chacha_store_lanes(const utils::array<Vector, 16> &x, std::uint32_t *out) {
+    alignas(sizeof(Vector)) std::uint32_t transposed[16][Lanes];
+
+    for (unsigned w = 0; w < 16; ++w) {
+        std::memcpy(transposed[w], &x[w], sizeof(Vector));
+    }
+    for (unsigned lane = 0; lane < Lanes; ++lane) {
+        for (unsigned w = 0; w < 16; ++w) {
+            out[lane * 16 + w] = transposed[w][lane];
+        }
+    }
+}
+
+#endif
+
+/// same as chacha_run_scalar, Lanes blocks at a time
+template <unsigned Lanes, unsigned R>
+ALEA_ALWAYS_INLINE inline void
+chacha_run_lanes(const utils::array<std::uint32_t, 16> &input,
+                 std::uint32_t *out, std::size_t nblocks) {
+    typedef typename simd_vector<std::uint32_t, Lanes>::type vector_type;
+    typedef utils::array<vector_type, 16> lanes_state_type;
+
+    alignas(sizeof(vector_type)) std::uint32_t lanes[Lanes];
+
+    vector_type lane_index;
+    for (unsigned lane = 0; lane < Lanes; ++lane) {
+        lanes[lane] = std::uint32_t(lane);
+    }
+    std::memcpy(&lane_index, lanes, sizeof(vector_type));
+
+    lanes_state_type input_lanes;
+    for (unsigned w = 0; w < 16; ++w) {
+        input_lanes[w] = vector_type{} + input[w];
+    }
+    input_lanes[12] += lane_index;
+
+    std::size_t i = 0;
+    for (; i + Lanes <= nblocks; i += Lanes, out += Lanes * 16) {
+        lanes_state_type start(input_lanes);
+        start[12] += std::uint32_t(i);
+        lanes_state_type x(start);
+
+        chacha_rounds_functor<R, lanes_state_type> func;
+        func(x);
+
+        for (unsigned w = 0; w < 16; ++w) {
+            x[w] += start[w];
+        }
+        chacha_store_lanes<Lanes>(x, out);
+    }
+
+    utils::array<std::uint32_t, 16> tail_input(input);
+    tail_input[12] += std::uint32_t(i);
+    chacha_run_scalar<R>(tail_input, out, nblocks - i);
+}
+
+template <unsigned R>
+ALEA_TARGET_SSE2 ALEA_FLATTEN inline void
+chacha_run_sse2(const utils::array<std::uint32_t, 16> &input,
+                std::uint32_t *out, std::size_t nblocks) {
+    chacha_run_lanes<simd_lanes<std::uint32_t, 16>(), R>(input, out,
+                                                         nblocks);
+}
+
+template <unsigned R>
+ALEA_TARGET_AVX2 ALEA_FLATTEN inline void
+chacha_run_avx2(const utils::array<std::uint32_t, 16> &input,
+                std::uint32_t *out, std::size_t nblocks) {
+    chacha_run_lanes<simd_lanes<std::uint32_t, 32>(), R>(input, out,
+                                                         nblocks);
+}
+
+template <unsigned R>
+ALEA_TARGET_AVX512 ALEA_FLATTEN inline void
+chacha_run_avx512(const utils::array<std::uint32_t, 16> &input,
+                  std::uint32_t *out, std::size_t nblocks) {
+    chacha_run_lanes<simd_lanes<std::uint32_t, 64>(), R>(input, out,
+                                                         nblocks);
+}
+
+#endif
+
+} // namespace impl
+
+template <unsigned R>
+inline void chacha<R>::encrypt_blocks(impl::simd_isa isa,
+                                      const domain_type &counter,
+                                      uint_type *out,
+                                      std::size_t nblocks) const {
+    domain_type ctr(counter);
+
+    while (nblocks > 0) {
+        const std::size_t run = impl::counter_run(ctr, nblocks);
+        const range_type input = state(ctr);
+
+        switch (isa) {
+#ifdef ALEA_SIMD_X86
+        case impl::simd_isa::avx512:
+            impl::chacha_run_avx512<R>(input, out, run);
+            break;
+        case impl::simd_isa::avx2:
+            impl::chacha_run_avx2<R>(input, out, run);
+            break;
+        case impl::simd_isa::sse2:
+            impl::chacha_run_sse2<R>(input, out, run);
+            break;
+#endif
+        default:
+            impl::chacha_run_scalar<R>(input, out, run);
+        }
+
+        impl::counter_add(ctr, run);
+        out += run * 16;
+        nblocks -= run;
+    }
+}
+
+} // namespace alea
+
+#endif // _ALEA_CHACHA_SIMD_IMPL_HPP_
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_IMPL_ENGINE_FILL_HPP_
+#define _ALEA_IMPL_ENGINE_FILL_HPP_
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace alea {
+
+namespace impl {
+
+template <typename Engine, typename = void>
+struct engine_block_size : std::integral_constant<std::size_t, 1> {};
+
+/// values per block ( per counter ) of a counter based engine, 1 for the
+/// other engines
+template <typename Engine>
+struct engine_block_size<
+    Engine,
+    std::void_t<decltype(std::tuple_size<typename Engine::range_type>::value)>>
+    : std::integral_constant<
+          std::size_t, std::tuple_size<typename Engine::range_type>::value> {
+};
+
+template <typename Engine, typename Iterator, typename = void>
+struct has_generate_n : std::false_type {};
+
+/// true if Engine provides a bulk generate_n(first, n)
+template <typename Engine, typename Iterator>
+struct has_generate_n<Engine, Iterator,
+                      std::void_t<decltype(std::declval<Engine &>().generate_n(
+                          std::declval<Iterator>(), std::size_t()))>>
+    : std::true_type {};
+
+/// write the n next values of engine to first, in bulk when the engine
+/// provides generate_n
+template <typename Engine, typename RandomIt>
+inline void fill_serial(Engine &engine, RandomIt first, std::size_t n) {
+    if constexpr (has_generate_n<Engine, RandomIt>::value) {
+        engine.generate_n(first, n);
+    } else {
+        for (; n > 0; --n, ++first) {
+            *first = engine();
+        }
+    }
+}
+
+} // namespace impl
+
+} // namespace alea
+
+#endif // _ALEA_IMPL_ENGINE_FILL_HPP_
@@ -0,0 +1,395 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_GF2_POLYNOMIAL_HPP_
+#define _ALEA_GF2_POLYNOMIAL_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+///
+/// arithmetic on polynomials over GF(2) modulo the characteristic
+/// polynomial of a linear random generator
+///
+/// For a generator whose transition is a linear map of GF(2)^Degree with
+/// characteristic polynomial P, advancing the state by n steps is the same
+/// as evaluating the polynomial x^n mod P on the transition:
+///     state_n = sum_i coef_i(x^n mod P) * state_i ,  i < Degree
+/// which costs O(log n) polynomial products and Degree generator steps
+/// ( see "Efficient jump ahead for F2-linear random number generators",
+///   Haramoto, Matsumoto, Nishimura, Panneton, L'Ecuyer, 2008 )
+///
+
+namespace alea {
+
+namespace impl {
+
+/// polynomial of degree < Degree, bit i of the words is the coefficient
+/// of x^i
+template <std::size_t Degree>
+using gf2_polynomial = std::array<std::uint64_t, Degree / 64 + 1>;
+
+template <std::size_t Degree>
+inline bool gf2_coefficient(const gf2_polynomial<Degree> &a, std::size_t i) {
+    return (a[i / 64] >> (i % 64)) & 1;
+}
+
+/// a = a * x mod P, where P = x^Degree + modulus
+template <std::size_t Degree>
+inline void gf2_mul_x(gf2_polynomial<Degree> &a,
+                      const gf2_polynomial<Degree> &modulus) {
+    std::uint64_t carry = 0;
+    for (std::uint64_t &w : a) {
+        const std::uint64_t next_carry = w >> 63;
+        w = (w << 1) | carry;
+        carry = next_carry;
+    }
+
+    if (gf2_coefficient<Degree>(a, Degree)) {
+        a[Degree / 64] ^= std::uint64_t(1) << (Degree % 64);
+        for (std::size_t w = 0; w < a.size(); ++w) {
+            a[w] ^= modulus[w];
+        }
+    }
+}
+
+/// a * b mod P, where P = x^Degree + modulus
+template <std::size_t Degree>
+inline gf2_polynomial<Degree>
+gf2_mulmod(const gf2_polynomial<Degree> &a, const gf2_polynomial<Degree> &b,
+           const gf2_polynomial<Degree> &modulus) {
+    gf2_polynomial<Degree> res{};
+    for (std::size_t i = Degree; i-- > 0;) {
+        gf2_mul_x<Degree>(res, modulus);
+        if (gf2_coefficient<Degree>(b, i)) {
+            for (std::size_t w = 0; w < res.size(); ++w) {
+                res[w] ^= a[w];
+            }
+        }
+    }
+    return res;
+}
+
+/// xor of the bits of x
+inline unsigned gf2_parity(std::uint64_t x) {
+    x ^= x >> 32;
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    x ^= x >> 2;
+    x ^= x >> 1;
+    return unsigned(x & 1);
+}
+
+/// x^n mod P, where P = x^Degree + modulus
+///
+/// n is given as little endian 64 bits words
+template <std::size_t Degree, std::size_t Words>
+inline gf2_polynomial<Degree>
+gf2_powmod_x(const std::array<std::uint64_t, Words> &n,
+             const gf2_polynomial<Degree> &modulus) {
+    gf2_polynomial<Degree> res{}, square{};
+    res[0] = 1;
+    square[0] = 1;
+    gf2_mul_x<Degree>(square, modulus);
+
+    for (std::size_t i = 0; i < 64 * Words; ++i) {
+        if ((n[i / 64] >> (i % 64)) & 1) {
+            res = gf2_mulmod<Degree>(res, square, modulus);
+        }
+        square = gf2_mulmod<Degree>(square, square, modulus);
+    }
+    return res;
+}
+
+/// x^(2^k) mod P, where P = x^Degree + modulus
+template <std::size_t Degree>
+inline gf2_polynomial<Degree>
+gf2_pow2_x(std::size_t k, const gf2_polynomial<Degree> &modulus) {
+    gf2_polynomial<Degree> res{};
+    res[0] = 1;
+    gf2_mul_x<Degree>(res, modulus);
+    for (std::size_t i = 0; i < k; ++i) {
+        res = gf2_mulmod<Degree>(res, res, modulus);
+    }
+    return res;
+}
+
+/// characteristic polynomial, without its leading term x^Degree,
+/// of a linear recurrence of order Degree from at least 2 * Degree terms
+/// of a sequence it generates ( Berlekamp-Massey algorithm )
+///
+/// The result is the characteristic polynomial of the generator when it
+/// is irreducible, which is the case of full period generators
+///
+/// The polynomials and the sequence window are packed in 64 bits words,
+/// the cost is O(n^2 / 64) for n terms
+template <std::size_t Degree>
+inline gf2_polynomial<Degree>
+gf2_berlekamp_massey(const std::vector<std::uint8_t> &sequence) {
+    const std::size_t n = sequence.size();
+    const std::size_t words = n / 64 + 2;
+
+    // bit j of c / b is the coefficient of x^j of the connection
+    // polynomials, bit j of window is the term i - j of the sequence
+    std::vector<std::uint64_t> c(words, 0), b(words, 0), t, window(words, 0);
+    c[0] = b[0] = 1;
+
+    std::size_t length = 0, m = 1;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint64_t carry = sequence[i] & 1;
+        for (std::uint64_t &w : window) {
+            const std::uint64_t next_carry = w >> 63;
+            w = (w << 1) | carry;
+            carry = next_carry;
+        }
+
+        // discrepancy: sum of c_j * s_(i - j) for j <= length
+        std::uint64_t parity = 0;
+        for (std::size_t w = 0; w <= length / 64; ++w) {
+            std::uint64_t terms = c[w] & window[w];
+            if (w == length / 64 && (length + 1) % 64 != 0) {
+                terms &= (std::uint64_t(1) << ((length + 1) % 64)) - 1;
+            }
+            parity ^= terms;
+        }
+
+        if (gf2_parity(parity) == 0) {
+            ++m;
+            continue;
+        }
+
+        const bool grow = 2 * length <= i;
+        if (grow) {
+            t = c;
+        }
+
+        // c = c + x^m b
+        const std::size_t shift_words = m / 64, shift_bits = m % 64;
+        for (std::size_t w = words; w-- > shift_words;) {
+            std::uint64_t shifted = b[w - shift_words] << shift_bits;
+            if (shift_bits != 0 && w > shift_words) {
+                shifted |= b[w - shift_words - 1] >> (64 - shift_bits);
+            }
+            c[w] ^= shifted;
+        }
+
+        if (grow) {
+            length = i + 1 - length;
+            b.swap(t);
+            m = 1;
+        } else {
+            ++m;
+        }
+    }
+
+    // connection polynomial c(x) to characteristic polynomial
+    // x^length c(1/x)
+    gf2_polynomial<Degree> modulus{};
+    for (std::size_t j = 0; j < length && j < Degree; ++j) {
+        const std::size_t k = length - j;
+        if ((c[k / 64] >> (k % 64)) & 1) {
+            modulus[j / 64] |= std::uint64_t(1) << (j % 64);
+        }
+    }
+    return modulus;
+}
+
+///
+/// polynomial arithmetic modulo P = x^Degree + modulus for large degrees
+/// ( e.g the 19937 of the mersenne twister )
+///
+/// gf2_mulmod costs Degree^2 / 32 word operations, gf2_modular processes
+/// the coefficients by windows of 4 bits with precomputed multiples:
+/// about Degree^2 / 512 word operations per product
+///
+template <std::size_t Degree> class gf2_modular {
+  public:
+    typedef gf2_polynomial<Degree> polynomial_type;
+
+    explicit gf2_modular(const polynomial_type &modulus)
+        : x_degree(), reduce_table() {
+        // reduce_table[q] = q(x) * x^Degree mod P, for deg(q) < 4
+        polynomial_type power = modulus;
+        x_degree = modulus;
+        for (std::size_t bit = 0; bit < 4; ++bit) {
+            for (std::size_t q = 0; q < 16; ++q) {
+                if ((q >> bit) & 1) {
+                    for (std::size_t w = 0; w < words; ++w) {
+                        reduce_table[q][w + 1] ^= power[w];
+                    }
+                }
+            }
+            gf2_mul_x<Degree>(power, modulus);
+        }
+    }
+
+    /// a * b mod P
+    polynomial_type multiply(const polynomial_type &a,
+                             const polynomial_type &b) const {
+        // multiples of a by the polynomials of degree < 4
+        std::array<std::array<std::uint64_t, words + 1>, 16> multiples{};
+        for (std::size_t w = 0; w < words; ++w) {
+            multiples[1][w] = a[w];
+        }
+        for (std::size_t q = 2; q < 16; q += 2) {
+            std::uint64_t carry = 0;
+            for (std::size_t w = 0; w <= words; ++w) {
+                multiples[q][w] = (multiples[q / 2][w] << 1) | carry;
+                carry = multiples[q / 2][w] >> 63;
+            }
+            for (std::size_t w = 0; w <= words; ++w) {
+                multiples[q + 1][w] = multiples[q][w] ^ a_word(a, w);
+            }
+        }
+
+        // comb method: the nibbles k of all the words of b at once
+        std::array<std::uint64_t, 2 * words + 1> product{};
+        for (std::size_t k = 64; k > 0;) {
+            k -= 4;
+            if (k != 60) {
+                shift_left_4(product);
+            }
+            for (std::size_t j = 0; j < words; ++j) {
+                const std::size_t q = (b[j] >> k) & 15;
+                if (q != 0) {
+                    for (std::size_t w = 0; w <= words; ++w) {
+                        product[j + w] ^= multiples[q][w];
+                    }
+                }
+            }
+        }
+
+        return reduce(product);
+    }
+
+    /// x^n mod P, n given as little endian 64 bits words
+    template <std::size_t Words>
+    polynomial_type pow_x(const std::array<std::uint64_t, Words> &n) const {
+        polynomial_type res{}, square{};
+        res[0] = 1;
+        square[0] = 2;
+        if (Degree == 1) {
+            square = x_degree;
+        }
+
+        std::size_t top = 64 * Words;
+        while (top > 0 && ((n[(top - 1) / 64] >> ((top - 1) % 64)) & 1) == 0) {
+            --top;
+        }
+        for (std::size_t i = 0; i < top; ++i) {
+            if ((n[i / 64] >> (i % 64)) & 1) {
+                res = multiply(res, square);
+            }
+            if (i + 1 < top) {
+                square = multiply(square, square);
+            }
+        }
+        return res;
+    }
+
+  private:
+    static constexpr std::size_t words = Degree / 64 + 1;
+
+    static std::uint64_t a_word(const polynomial_type &a, std::size_t w) {
+        return w < words ? a[w] : 0;
+    }
+
+    template <std::size_t N>
+    static void shift_left_4(std::array<std::uint64_t, N> &x) {
+        std::uint64_t carry = 0;
+        for (std::uint64_t &w : x) {
+            const std::uint64_t next_carry = w >> 60;
+            w = (w << 4) | carry;
+            carry = next_carry;
+        }
+    }
+
+    /// product mod P, by nibbles from the top
+    polynomial_type
+    reduce(std::array<std::uint64_t, 2 * words + 1> &product) const {
+        const std::size_t bits = 64 * product.size();
+        for (std::size_t k = (bits - Degree) / 4 * 4 + 4; k > 0;) {
+            k -= 4;
+            const std::size_t pos = Degree + k;
+            if (pos >= bits) {
+                continue;
+            }
+
+            // coefficients of x^pos .. x^(pos + 3)
+            std::uint64_t q = product[pos / 64] >> (pos % 64);
+            if (pos % 64 > 60 && pos / 64 + 1 < product.size()) {
+                q |= product[pos / 64 + 1] << (64 - pos % 64);
+            }
+            q &= 15;
+            if (q == 0) {
+                continue;
+            }
+
+            for (std::size_t bit = 0; bit < 4; ++bit) {
+                if ((q >> bit) & 1) {
+                    product[(pos + bit) / 64] ^= std::uint64_t(1)
+                                                 << ((pos + bit) % 64);
+                }
+            }
+
+            // + reduce_table[q] * x^k, the table rows have a zero word
+            // at both ends
+            const std::size_t shift_words = k / 64, shift_bits = k % 64;
+            const std::uint64_t *row = reduce_table[q].data();
+            std::uint64_t *dest = product.data() + shift_words;
+            if (shift_bits == 0) {
+                for (std::size_t w = 0; w < words; ++w) {
+                    dest[w] ^= row[w + 1];
+                }
+            } else {
+                for (std::size_t w = 0; w <= words; ++w) {
+                    dest[w] ^= (row[w + 1] << shift_bits) |
+                               (row[w] >> (64 - shift_bits));
+                }
+            }
+        }
+
+        polynomial_type res;
+        for (std::size_t w = 0; w < words; ++w) {
+            res[w] = product[w];
+        }
+        return res;
+    }
+
+    polynomial_type x_degree;
+    std::array<std::array<std::uint64_t, words + 2>, 16> reduce_table;
+};
+
+} // namespace impl
+
+} // namespace alea
+
+#endif // _ALEA_GF2_POLYNOMIAL_HPP_
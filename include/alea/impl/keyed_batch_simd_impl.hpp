@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_KEYED_BATCH_SIMD_IMPL_HPP_
+#define _ALEA_KEYED_BATCH_SIMD_IMPL_HPP_
+
+#include <cstring>
+
+#include "../keyed_batch.hpp"
+#include "simd_dispatch.hpp"
+
+///
+/// multi-lane kernels of keyed_batch<threefry>
+///
+/// Contrary to the bulk threefry kernels, every lane has its own key:
+/// the key schedule words are loaded as lane vectors from the structure
+/// of arrays, and the rounds_functor receives a vector key schedule
+///
+
+namespace alea {
+
+namespace impl {
+
+/// entities [first, last) one at a time
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+inline void keyed_batch_run_scalar(const Uint *schedules, std::size_t stride,
+                                   const utils::array<Uint, N> *counters,
+                                   std::size_t counter_stride,
+                                   utils::array<Uint, N> *out,
+                                   std::size_t first, std::size_t last) {
+    typedef utils::array<Uint, N> domain_type;
+
+    for (std::size_t i = first; i < last; ++i) {
+        utils::array<Uint, N + 1> ks;
+        for (unsigned w = 0; w <= N; ++w) {
+            ks[w] = schedules[w * stride + i];
+        }
+
+        domain_type c(counters[i * counter_stride]);
+        for (unsigned w = 0; w < N; ++w) {
+            c[w] += ks[w];
+        }
+
+        rounds_functor<R, R, Uint, domain_type, Constants, N> func;
+        func(ks, c);
+        out[i] = c;
+    }
+}
+
+#ifdef ALEA_SIMD_X86
+
+/// same as keyed_batch_run_scalar, Lanes entities at a time
+template <unsigned Lanes, unsigned N, typename Uint, unsigned R,
+          typename Constants>
+ALEA_ALWAYS_INLINE inline void
+keyed_batch_run_lanes(const Uint *schedules, std::size_t stride,
+                      const utils::array<Uint, N> *counters,
+                      std::size_t counter_stride, utils::array<Uint, N> *out,
+                      std::size_t n) {
+    typedef typename simd_vector<Uint, Lanes>::type vector_type;
+    typedef utils::array<vector_type, N> lanes_domain_type;
+
+    alignas(sizeof(vector_type)) Uint transposed[N][Lanes];
+
+    std::size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes) {
+        utils::array<vector_type, N + 1> ks;
+        for (unsigned w = 0; w <= N; ++w) {
+            std::memcpy(&ks[w], schedules + w * stride + i,
+                        sizeof(vector_type));
+        }
+
+        lanes_domain_type c{};
+        if (counter_stride == 0) {
+            for (unsigned w = 0; w < N; ++w) {
+                c[w] = vector_type{} + counters[0][w];
+            }
+        } else {
+            for (unsigned lane = 0; lane < Lanes; ++lane) {
+                for (unsigned w = 0; w < N; ++w) {
+                    transposed[w][lane] =
+                        counters[(i + lane) * counter_stride][w];
+                }
+            }
+            for (unsigned w = 0; w < N; ++w) {
+                std::memcpy(&c[w], transposed[w], sizeof(vector_type));
+            }
+        }
+
+        for (unsigned w = 0; w < N; ++w) {
+            c[w] += ks[w];
+        }
+
+        rounds_functor<R, R, Uint, lanes_domain_type, Constants, N> func;
+        func(ks, c);
+
+        for (unsigned w = 0; w < N; ++w) {
+            std::memcpy(transposed[w], &c[w], sizeof(vector_type));
+        }
+        for (unsigned lane = 0; lane < Lanes; ++lane) {
+            for (unsigned w = 0; w < N; ++w) {
+                out[i + lane][w] = transposed[w][lane];
+            }
+        }
+    }
+
+    keyed_batch_run_scalar<N, Uint, R, Constants>(
+        schedules, stride, counters, counter_stride, out, i, n);
+}
+
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+ALEA_TARGET_AVX2 ALEA_FLATTEN inline void
+keyed_batch_run_avx2(const Uint *schedules, std::size_t stride,
+                     const utils::array<Uint, N> *counters,
+                     std::size_t counter_stride, utils::array<Uint, N> *out,
+                     std::size_t n) {
+    keyed_batch_run_lanes<simd_lanes<Uint, 32>(), N, Uint, R, Constants>(
+        schedules, stride, counters, counter_stride, out, n);
+}
+
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+ALEA_TARGET_AVX512 ALEA_FLATTEN inline void
+keyed_batch_run_avx512(const Uint *schedules, std::size_t stride,
+                       const utils::array<Uint, N> *counters,
+                       std::size_t counter_stride,
+                       utils::array<Uint, N> *out, std::size_t n) {
+    keyed_batch_run_lanes<simd_lanes<Uint, 64>(), N, Uint, R, Constants>(
+        schedules, stride, counters, counter_stride, out, n);
+}
+
+#endif
+
+} // namespace impl
+
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+inline void keyed_batch<threefry<N, Uint, R, Constants>>::encrypt(
+    impl::simd_isa isa, const domain_type *counters,
+    std::size_t counter_stride, range_type *out) const {
+    switch (isa) {
+#ifdef ALEA_SIMD_X86
+    case impl::simd_isa::avx512:
+        impl::keyed_batch_run_avx512<N, Uint, R, Constants>(
+            schedules.data(), stride, counters, counter_stride, out, n_keys);
+        break;
+    case impl::simd_isa::avx2:
+        impl::keyed_batch_run_avx2<N, Uint, R, Constants>(
+            schedules.data(), stride, counters, counter_stride, out, n_keys);
+        break;
+#endif
+    default:
+        impl::keyed_batch_run_scalar<N, Uint, R, Constants>(
+            schedules.data(), stride, counters, counter_stride, out, 0,
+            n_keys);
+    }
+}
+
+} // namespace alea
+
+#endif // _ALEA_KEYED_BATCH_SIMD_IMPL_HPP_
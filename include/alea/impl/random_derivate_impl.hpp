@@ -30,72 +30,77 @@
 #ifndef RANDOM_DERIVATE_IMPL_HPP
 #define RANDOM_DERIVATE_IMPL_HPP
 
-#include <array>
-#include <bitset>
 #include <cstdint>
-#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "../seed_seq.hpp"
+#include "../threefry.hpp"
 
 namespace alea {
 
 namespace impl {
-/*
-template <typename Uint>
-inline alea::sha1::digest32_t generate_deterministic_seed_160(Uint origin_seed,
-Uint key) {
-   // let's add a bit of salt to our meal today
-  std::array<std::uint8_t, 16> salt = {
-       {0x6c, 0x77, 0xad, 0xb8, 0x3e, 0xf8, 0x21, 0x61, 0xc3, 0xd8, 0x2e, 0x4c,
-0x13, 0xfd, 0x75, 0xd3}};
-
-   alea::sha1 sha_compute;
-   //  we want to generate a new seed determinitically 'seed = f(old_seed, key)'
-   //  the new seed need to be free or any  statistics correlation from old_seed
-and key
-   //
-   // we do
-   //   new_seed = sha1( concat(salt, key, origin_seed) )
-   //
-   // we return then the first 32 bits from the generations
-   sha_compute.process_block(salt.begin(), salt.end());
-   sha_compute.process(key);
-   sha_compute.process(origin_seed);
-   return sha_compute.get_digest();
+
+template <typename Engine, typename = void>
+struct has_seed_seq : std::false_type {};
+
+/// true if Engine can be seeded from a seed sequence
+template <typename Engine>
+struct has_seed_seq<Engine,
+                    std::void_t<decltype(std::declval<Engine &>().seed(
+                        std::declval<threefry_seed_seq &>()))>>
+    : std::true_type {};
+
+/// salt of the derivation, digits of pi
+constexpr std::uint64_t derivate_salt = UINT64_C(0x243F6A8885A308D3);
+
+/// key of the child of an engine whose next outputs are outputs,
+/// for the derivation key
+///
+/// The mixer is a threefry4x64 block keyed by the parent outputs,
+/// on the counter ( key, salt )
+inline threefry4x64::key_type
+derivate_key(const threefry4x64::key_type &outputs, std::uint64_t key) {
+    const threefry4x64 mixer(outputs);
+    return mixer({{key, derivate_salt, 0, 0}});
 }
 
-*/
+/// reseed engine as the child, for key, of an engine whose next
+/// outputs are outputs, see random_engine_derivate
+template <typename Engine>
+inline void derivate_reseed(Engine &engine,
+                            const threefry4x64::key_type &outputs,
+                            std::uint64_t key) {
+    const threefry4x64::key_type child_key = derivate_key(outputs, key);
+
+    if constexpr (has_seed_seq<Engine>::value) {
+        threefry_seed_seq seq(child_key);
+        engine.seed(seq);
+    } else {
+        engine.seed(static_cast<typename Engine::result_type>(child_key[0]));
+    }
+}
 
 } // namespace impl
 
+///
+/// generic derivation: the child is the engine reseeded from
+/// impl::derivate_key of 4 outputs of the parent and of the key
+///
+/// Engines that accept a seed sequence are seeded from a threefry_seed_seq
+/// ( one pass over their state, no std::seed_seq warm up ), the other
+/// ones from a single mixed value
+///
 template <typename Engine>
 inline Engine random_engine_derivate(const Engine &engine,
                                      const typename Engine::result_type &key) {
     Engine res(engine);
 
-    typename Engine::result_type old_val = res();
-    /*
-        // compute a new  seed determinitically
-        alea::sha1::digest32_t digest =
-       impl::generate_deterministic_seed_160<typename
-       Engine::result_type>(old_val, key); typename Engine::result_type
-       new_seed; std::memcpy(&new_seed, &(digest[0]), sizeof(typename
-       Engine::result_type));
-
-        // use it
-        res.seed(new_seed);
-
-        // use the digest to increase entropy even more
-        // we get the number of 1 bits in our digest and
-        // initialize our random engine from 0 to n
-        for (alea::sha1::digest32_t::iterator it = digest.begin(); it <
-       digest.end(); ++it) {
-
-            std::bitset<32> bits(*it);
-            const std::uint64_t iteration = bits.count();
-            for (std::uint64_t i = 0; i < iteration; ++i) {
-                (void)res();
-            }
-        }*/
-
+    threefry4x64::key_type outputs;
+    for (std::uint64_t &output : outputs) {
+        output = static_cast<std::uint64_t>(res());
+    }
+    impl::derivate_reseed(res, outputs, static_cast<std::uint64_t>(key));
     return res;
 }
 
@@ -29,8 +29,16 @@
 #ifndef RANDOM_ENGINE_MAPPER_MISC_HPP
 #define RANDOM_ENGINE_MAPPER_MISC_HPP
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
 
+#include "../jump.hpp"
 #include "../random_derivate.hpp"
 #include "../random_engine_mapper.hpp"
 
@@ -38,6 +46,48 @@ namespace alea {
 
 namespace impl {
 
+template <typename Engine, typename Iterator, typename = void>
+struct has_engine_fill : std::false_type {};
+
+/// true if Engine provides a bulk fill(first, last)
+template <typename Engine, typename Iterator>
+struct has_engine_fill<
+    Engine, Iterator,
+    std::void_t<decltype(std::declval<Engine &>().fill(
+        std::declval<Iterator>(), std::declval<Iterator>()))>>
+    : std::true_type {};
+
+template <typename Engine, typename = void>
+struct has_member_derivate : std::false_type {};
+
+/// true if Engine provides derivate(result_type), as the engines with
+/// their own random_engine_derivate
+template <typename Engine>
+struct has_member_derivate<
+    Engine, std::void_t<decltype(std::declval<const Engine &>().derivate(
+                std::declval<typename Engine::result_type>()))>>
+    : std::true_type {};
+
+/// largest engine saved before each batch of a random_engine_mapper
+constexpr std::size_t mapper_snapshot_size = 128;
+
+/// true if the mapped engine is saved before each batch, to be derivated
+/// at the position of the mapper. The large engines of the generic
+/// derivation are not: their child only depends on their next outputs,
+/// which are in the buffer when their type fits in Uint
+template <typename Uint, typename Engine> constexpr bool mapper_keeps_start() {
+    if constexpr (sizeof(Engine) <= mapper_snapshot_size ||
+                  has_member_derivate<Engine>::value) {
+        return true;
+    } else {
+        return std::numeric_limits<typename Engine::result_type>::digits >
+               std::numeric_limits<Uint>::digits;
+    }
+}
+
+/// no engine saved, see mapper_keeps_start
+struct mapper_no_start {};
+
 template <typename Uint> class abstract_engine {
   public:
     typedef Uint result_type;
@@ -50,9 +100,34 @@ template <typename Uint> class abstract_engine {
 
     virtual result_type generate() = 0;
 
-    virtual abstract_engine *clone() = 0;
+    /// write the n next values to out
+    virtual void fill(result_type *out, std::size_t n) = 0;
+
+    /// fill, keeping a copy of the engine before the first value
+    virtual void refill(result_type *out, std::size_t n) = 0;
+
+    /// skip n values, see alea::jump
+    virtual void map_jump(counter_wide_uint n) = 0;
+
+    /// size and alignment of the concrete engine object
+    virtual std::size_t size() const = 0;
+    virtual std::size_t alignment() const = 0;
+
+    /// construct a copy, a moved copy or a derivated engine of the same
+    /// type in storage, of at least size() bytes aligned on alignment()
+    virtual abstract_engine *clone(void *storage) const = 0;
 
-    virtual abstract_engine *derivate(result_type key) const = 0;
+    virtual abstract_engine *move(void *storage) = 0;
+
+    virtual abstract_engine *derivate(void *storage,
+                                      result_type key) const = 0;
+
+    /// derivate the engine as it was pos values after the start of
+    /// the last refill(), next are the n_next values left of the refill
+    virtual abstract_engine *derivate_at(void *storage, result_type key,
+                                         std::size_t pos,
+                                         const result_type *next,
+                                         std::size_t n_next) const = 0;
 
   private:
 };
@@ -62,7 +137,21 @@ class map_engine_intern : public abstract_engine<Uint> {
   public:
     typedef Uint result_type;
 
-    map_engine_intern(const Engine &e) : _e(e) {}
+    static constexpr bool keeps_start = mapper_keeps_start<Uint, Engine>();
+
+    typedef typename std::conditional<keeps_start, Engine,
+                                      mapper_no_start>::type start_type;
+
+    map_engine_intern(const Engine &e) : _e(e), _start(initial_start(_e)) {}
+
+    map_engine_intern(Engine &&e)
+        : _e(std::move(e)), _start(initial_start(_e)) {}
+
+    map_engine_intern(const Engine &e, const start_type &start)
+        : _e(e), _start(start) {}
+
+    map_engine_intern(Engine &&e, start_type &&start)
+        : _e(std::move(e)), _start(std::move(start)) {}
 
     virtual void map_seed() { _e.seed(); }
 
@@ -70,61 +159,285 @@ class map_engine_intern : public abstract_engine<Uint> {
 
     virtual result_type generate() { return _e(); }
 
-    virtual abstract_engine<result_type> *clone() {
-        return new map_engine_intern(_e);
+    virtual void fill(result_type *out, std::size_t n) {
+        // bulk path of the engine ( e.g counter_engine SIMD kernels )
+        if constexpr (std::is_same<typename Engine::result_type,
+                                   result_type>::value &&
+                      has_engine_fill<Engine, result_type *>::value) {
+            _e.fill(out, out + n);
+        } else {
+            if constexpr (sizeof(Engine) <= 64) {
+                // small state: work on a local copy kept in registers,
+                // out could alias the member state otherwise
+                Engine e(std::move(_e));
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] = result_type(e());
+                }
+                _e = std::move(e);
+            } else {
+                for (std::size_t i = 0; i < n; ++i) {
+                    out[i] = result_type(_e());
+                }
+            }
+        }
+    }
+
+    virtual void refill(result_type *out, std::size_t n) {
+        if constexpr (keeps_start) {
+            _start = _e;
+        }
+        fill(out, n);
+    }
+
+    virtual void map_jump(counter_wide_uint n) { jump(_e, n); }
+
+    virtual std::size_t size() const { return sizeof(map_engine_intern); }
+
+    virtual std::size_t alignment() const {
+        return alignof(map_engine_intern);
     }
 
-    virtual abstract_engine<result_type> *derivate(result_type key) const {
-        Engine derivated_engine = random_engine_derivate(_e, key);
-        map_engine_intern<result_type, Engine> *ret =
-            new map_engine_intern<result_type, Engine>(derivated_engine);
-        return ret;
+    virtual abstract_engine<result_type> *clone(void *storage) const {
+        return new (storage) map_engine_intern(_e, _start);
+    }
+
+    virtual abstract_engine<result_type> *move(void *storage) {
+        return new (storage)
+            map_engine_intern(std::move(_e), std::move(_start));
+    }
+
+    virtual abstract_engine<result_type> *derivate(void *storage,
+                                                   result_type key) const {
+        return new (storage)
+            map_engine_intern(random_engine_derivate(_e, key));
+    }
+
+    virtual abstract_engine<result_type> *
+    derivate_at(void *storage, result_type key, std::size_t pos,
+                const result_type *next, std::size_t n_next) const {
+        if constexpr (keeps_start) {
+            // pos is below the batch size, cheaper to step than to jump
+            (void)next;
+            (void)n_next;
+            Engine e(_start);
+            for (std::size_t i = 0; i < pos; ++i) {
+                (void)e();
+            }
+            return new (storage)
+                map_engine_intern(random_engine_derivate(e, key));
+        } else {
+            // generic derivation of the engine at the position: reseed
+            // from its next outputs, the buffered values then the engine
+            (void)pos;
+            Engine e(_e);
+            threefry4x64::key_type outputs;
+            for (std::size_t i = 0; i < outputs.size(); ++i) {
+                outputs[i] = i < n_next ? std::uint64_t(next[i])
+                                        : static_cast<std::uint64_t>(e());
+            }
+            derivate_reseed(e, outputs,
+                            static_cast<std::uint64_t>(
+                                typename Engine::result_type(key)));
+            return new (storage) map_engine_intern(std::move(e));
+        }
     }
 
   private:
+    static start_type initial_start(const Engine &e) {
+        if constexpr (keeps_start) {
+            return e;
+        } else {
+            (void)e;
+            return start_type();
+        }
+    }
+
     Engine _e;
+    /// engine before the values of the last refill(), see
+    /// mapper_keeps_start
+    start_type _start;
 };
 
 } // namespace impl
 
-template <typename Uint>
-template <typename Engine>
-random_engine_mapper<Uint>::random_engine_mapper(Engine &&e)
-    : _engine(new impl::map_engine_intern<Uint, Engine>(std::move(e))) {}
+template <typename Uint, std::size_t InlineSize>
+template <typename Engine, typename>
+random_engine_mapper<Uint, InlineSize>::random_engine_mapper(
+    Engine &&e, std::pmr::memory_resource *resource)
+    : _engine(nullptr), _resource(resource), _buffer(), _pos(buffer_size) {
+    typedef impl::map_engine_intern<Uint, typename std::decay<Engine>::type>
+        intern_type;
+
+    _engine = new (allocate(sizeof(intern_type), alignof(intern_type)))
+        intern_type(std::forward<Engine>(e));
+}
+
+template <typename Uint, std::size_t InlineSize>
+random_engine_mapper<Uint, InlineSize>::random_engine_mapper()
+    : _engine(nullptr), _resource(std::pmr::get_default_resource()),
+      _buffer(), _pos(buffer_size) {}
+
+template <typename Uint, std::size_t InlineSize>
+random_engine_mapper<Uint, InlineSize>::random_engine_mapper(
+    const random_engine_mapper &other)
+    : _engine(nullptr), _resource(other._resource), _buffer(other._buffer),
+      _pos(other._pos) {
+    if (other._engine) {
+        _engine = other._engine->clone(
+            allocate(other._engine->size(), other._engine->alignment()));
+    }
+}
+
+template <typename Uint, std::size_t InlineSize>
+random_engine_mapper<Uint, InlineSize>::random_engine_mapper(
+    random_engine_mapper &&other)
+    : _engine(nullptr), _resource(other._resource), _buffer(other._buffer),
+      _pos(other._pos) {
+    if (other.is_inline()) {
+        _engine = other._engine->move(_storage);
+        other.reset();
+    } else {
+        // steal the allocated engine
+        _engine = other._engine;
+        other._engine = nullptr;
+    }
+    other._pos = buffer_size;
+}
+
+template <typename Uint, std::size_t InlineSize>
+random_engine_mapper<Uint, InlineSize> &
+random_engine_mapper<Uint, InlineSize>::operator=(
+    const random_engine_mapper &other) {
+    if (this != &other) {
+        random_engine_mapper copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+template <typename Uint, std::size_t InlineSize>
+random_engine_mapper<Uint, InlineSize> &
+random_engine_mapper<Uint, InlineSize>::operator=(
+    random_engine_mapper &&other) {
+    if (this != &other) {
+        reset();
+        // an allocated engine can only be stolen with its resource
+        _resource = other._resource;
+        if (other.is_inline()) {
+            _engine = other._engine->move(_storage);
+            other.reset();
+        } else {
+            _engine = other._engine;
+            other._engine = nullptr;
+        }
+        _buffer = other._buffer;
+        _pos = other._pos;
+        other._pos = buffer_size;
+    }
+    return *this;
+}
+
+template <typename Uint, std::size_t InlineSize>
+random_engine_mapper<Uint, InlineSize>::~random_engine_mapper() {
+    reset();
+}
 
-template <typename Uint>
-random_engine_mapper<Uint>::random_engine_mapper() : _engine() {}
+template <typename Uint, std::size_t InlineSize>
+void *random_engine_mapper<Uint, InlineSize>::allocate(std::size_t size,
+                                                       std::size_t align) {
+    if (size <= InlineSize && align <= alignof(std::max_align_t)) {
+        return _storage;
+    }
+    return _resource->allocate(size, align);
+}
+
+template <typename Uint, std::size_t InlineSize>
+void random_engine_mapper<Uint, InlineSize>::reset() {
+    if (_engine == nullptr) {
+        return;
+    }
 
-template <typename Uint>
-random_engine_mapper<Uint>::random_engine_mapper(
-    random_engine_mapper<Uint> &&other)
-    : _engine(std::move(other._engine)) {}
+    const bool allocated = !is_inline();
+    const std::size_t size = _engine->size();
+    const std::size_t align = _engine->alignment();
+    void *memory = _engine;
 
-template <typename Uint> void random_engine_mapper<Uint>::seed() {
-    assert(_engine.get());
+    _engine->~abstract_engine();
+    _engine = nullptr;
+    if (allocated) {
+        _resource->deallocate(memory, size, align);
+    }
+}
+
+template <typename Uint, std::size_t InlineSize>
+void random_engine_mapper<Uint, InlineSize>::seed() {
+    assert(_engine);
     _engine->map_seed();
+    _pos = buffer_size;
 }
 
-template <typename Uint>
-void random_engine_mapper<Uint>::seed(result_type seed) {
-    assert(_engine.get());
+template <typename Uint, std::size_t InlineSize>
+void random_engine_mapper<Uint, InlineSize>::seed(result_type seed) {
+    assert(_engine);
     _engine->map_seed(seed);
+    _pos = buffer_size;
 }
 
-template <typename Uint>
-typename random_engine_mapper<Uint>::result_type
-random_engine_mapper<Uint>::operator()() {
-    assert(_engine.get());
-    return _engine->generate();
+template <typename Uint, std::size_t InlineSize>
+typename random_engine_mapper<Uint, InlineSize>::result_type
+random_engine_mapper<Uint, InlineSize>::operator()() {
+    if (_pos == buffer_size) {
+        assert(_engine);
+        _engine->refill(_buffer.data(), buffer_size);
+        _pos = 0;
+    }
+    return _buffer[_pos++];
 }
 
-template <typename Uint>
-random_engine_mapper<Uint>
-random_engine_mapper<Uint>::derivate(result_type key) const {
-    assert(_engine.get());
+template <typename Uint, std::size_t InlineSize>
+void random_engine_mapper<Uint, InlineSize>::fill(result_type *out,
+                                                  std::size_t n) {
+    // values already buffered first
+    for (; _pos != buffer_size && n > 0; --n) {
+        *out++ = _buffer[_pos++];
+    }
+    if (n > 0) {
+        assert(_engine);
+        _engine->fill(out, n);
+    }
+}
+
+template <typename Uint, std::size_t InlineSize>
+void random_engine_mapper<Uint, InlineSize>::discard(
+    impl::counter_wide_uint n) {
+    // values already buffered first
+    const std::size_t buffered = buffer_size - _pos;
+    if (n <= buffered) {
+        _pos += std::size_t(n);
+        return;
+    }
+    assert(_engine);
+    _engine->map_jump(n - buffered);
+    _pos = buffer_size;
+}
+
+template <typename Uint, std::size_t InlineSize>
+random_engine_mapper<Uint, InlineSize>
+random_engine_mapper<Uint, InlineSize>::derivate(result_type key) const {
+    assert(_engine);
     random_engine_mapper res;
-    res._engine.reset(_engine->derivate(key));
+    res._resource = _resource;
+    void *storage = res.allocate(_engine->size(), _engine->alignment());
 
+    if (_pos == buffer_size) {
+        res._engine = _engine->derivate(storage, key);
+    } else {
+        // the mapped engine is ahead by the buffered values, derivate
+        // the engine at the position of the mapper instead
+        res._engine = _engine->derivate_at(storage, key, _pos,
+                                           _buffer.data() + _pos,
+                                           buffer_size - _pos);
+    }
     return res;
 }
 
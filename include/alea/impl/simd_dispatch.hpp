@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_SIMD_DISPATCH_HPP_
+#define _ALEA_SIMD_DISPATCH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+///
+/// runtime CPU feature detection and SIMD lane types
+///
+/// The multi-lane kernels of alea are written with the GCC / Clang
+/// vector extensions: the same generic code is compiled once per
+/// instruction set by wrapping it into a function carrying a target
+/// attribute, and the right one is selected at runtime
+///
+/// Define ALEA_DISABLE_SIMD to force the scalar implementation
+///
+
+#if !defined(ALEA_DISABLE_SIMD) && defined(__GNUC__) &&                       \
+    (defined(__x86_64__) || defined(__i386__))
+#define ALEA_SIMD_X86 1
+#define ALEA_TARGET_SSE2 __attribute__((target("sse2")))
+#define ALEA_TARGET_AVX2 __attribute__((target("avx2")))
+#define ALEA_TARGET_AVX512 __attribute__((target("avx512f")))
+#define ALEA_TARGET_AES __attribute__((target("sse2,aes")))
+#endif
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_shufflevector)
+#define ALEA_HAS_SHUFFLEVECTOR 1
+#endif
+#endif
+
+#if defined(__GNUC__)
+#define ALEA_ALWAYS_INLINE __attribute__((always_inline))
+#define ALEA_FLATTEN __attribute__((flatten))
+#else
+#define ALEA_ALWAYS_INLINE
+#define ALEA_FLATTEN
+#endif
+
+namespace alea {
+
+namespace impl {
+
+/// instruction sets for which alea provides multi-lane kernels
+enum class simd_isa { scalar, sse2, avx2, avx512 };
+
+inline const char *simd_isa_name(simd_isa isa) {
+    switch (isa) {
+    case simd_isa::sse2:
+        return "sse2";
+    case simd_isa::avx2:
+        return "avx2";
+    case simd_isa::avx512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+/// return true if the running CPU can execute kernels for isa
+inline bool simd_isa_supported(simd_isa isa) {
+    switch (isa) {
+    case simd_isa::scalar:
+        return true;
+#ifdef ALEA_SIMD_X86
+    case simd_isa::sse2:
+        return __builtin_cpu_supports("sse2");
+    case simd_isa::avx2:
+        return __builtin_cpu_supports("avx2");
+    case simd_isa::avx512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+/// widest instruction set supported by the running CPU
+/// detected once at first call
+inline simd_isa simd_isa_best() {
+    static const simd_isa best = []() {
+        if (simd_isa_supported(simd_isa::avx512)) {
+            return simd_isa::avx512;
+        }
+        if (simd_isa_supported(simd_isa::avx2)) {
+            return simd_isa::avx2;
+        }
+        if (simd_isa_supported(simd_isa::sse2)) {
+            return simd_isa::sse2;
+        }
+        return simd_isa::scalar;
+    }();
+    return best;
+}
+
+/// implementations of the AES rounds used by the AES based cbrngs
+enum class aes_impl { software, aes_ni };
+
+inline const char *aes_impl_name(aes_impl impl) {
+    return (impl == aes_impl::aes_ni) ? "aes_ni" : "software";
+}
+
+/// return true if the running CPU can execute the aes implementation impl
+inline bool aes_impl_supported(aes_impl impl) {
+    switch (impl) {
+    case aes_impl::software:
+        return true;
+#ifdef ALEA_SIMD_X86
+    case aes_impl::aes_ni:
+        return __builtin_cpu_supports("aes");
+#endif
+    default:
+        return false;
+    }
+}
+
+/// fastest aes implementation supported by the running CPU
+/// detected once at first call
+inline aes_impl aes_impl_best() {
+    static const aes_impl best = aes_impl_supported(aes_impl::aes_ni)
+                                     ? aes_impl::aes_ni
+                                     : aes_impl::software;
+    return best;
+}
+
+#ifdef ALEA_SIMD_X86
+
+/// vector of Lanes Uint words, one per independent block
+template <typename Uint, unsigned Lanes> struct simd_vector {};
+
+template <> struct simd_vector<std::uint32_t, 4> {
+    typedef std::uint32_t type __attribute__((vector_size(16)));
+};
+
+template <> struct simd_vector<std::uint32_t, 8> {
+    typedef std::uint32_t type __attribute__((vector_size(32)));
+};
+
+template <> struct simd_vector<std::uint32_t, 16> {
+    typedef std::uint32_t type __attribute__((vector_size(64)));
+};
+
+template <> struct simd_vector<std::uint64_t, 4> {
+    typedef std::uint64_t type __attribute__((vector_size(32)));
+};
+
+template <> struct simd_vector<std::uint64_t, 8> {
+    typedef std::uint64_t type __attribute__((vector_size(64)));
+};
+
+/// number of Uint lanes in a register of the given width (in bytes)
+template <typename Uint, std::size_t RegisterBytes>
+constexpr unsigned simd_lanes() {
+    return static_cast<unsigned>(RegisterBytes / sizeof(Uint));
+}
+
+#endif
+
+} // namespace impl
+
+} // namespace alea
+
+#endif // _ALEA_SIMD_DISPATCH_HPP_
@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_THREEFRY_SIMD_IMPL_HPP_
+#define _ALEA_THREEFRY_SIMD_IMPL_HPP_
+
+#include <cstring>
+
+#include "../threefry.hpp"
+#include "block_counter.hpp"
+#include "simd_dispatch.hpp"
+
+///
+/// multi-lane threefry kernels
+///
+/// Lanes consecutive counters are encrypted at once in a transposed
+/// layout: word w of the Lanes blocks lives in a single vector register.
+/// The rounds are the same compile-time unrolled rounds_functor than the
+/// scalar version, instantiated on lane vectors instead of words.
+///
+/// AVX2 processes 4 blocks of 64 bits words (8 of 32 bits) per iteration,
+/// AVX-512 processes 8 blocks of 64 bits words (16 of 32 bits) and maps
+/// the rotations to the native vprolq / vprold instructions
+///
+
+namespace alea {
+
+namespace impl {
+
+/// encrypt the nblocks counters keyed + 0, ..., keyed + nblocks - 1
+/// where keyed is the first counter already added to the key
+/// and the first counter word does not wrap around
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+inline void threefry_run_scalar(const utils::array<Uint, N + 1> &ks,
+                                const utils::array<Uint, N> &keyed,
+                                Uint *out, std::size_t nblocks) {
+    typedef utils::array<Uint, N> domain_type;
+
+    for (std::size_t i = 0; i < nblocks; ++i, out += N) {
+        domain_type c(keyed);
+        c[0] += Uint(i);
+
+        rounds_functor<R, R, Uint, domain_type, Constants, N> func;
+        func(ks, c);
+
+        utils::copy(c.begin(), c.end(), out);
+    }
+}
+
+#ifdef ALEA_SIMD_X86
+
+/// same as threefry_run_scalar, Lanes blocks at a time
+template <unsigned Lanes, unsigned N, typename Uint, unsigned R,
+          typename Constants>
+ALEA_ALWAYS_INLINE inline void
+threefry_run_lanes(const utils::array<Uint, N + 1> &ks,
+                   const utils::array<Uint, N> &keyed, Uint *out,
+                   std::size_t nblocks) {
+    typedef typename simd_vector<Uint, Lanes>::type vector_type;
+    typedef utils::array<vector_type, N> lanes_domain_type;
+
+    alignas(sizeof(vector_type)) Uint transposed[N][Lanes];
+
+    vector_type lane_index;
+    for (unsigned lane = 0; lane < Lanes; ++lane) {
+        transposed[0][lane] = Uint(lane);
+    }
+    std::memcpy(&lane_index, transposed[0], sizeof(vector_type));
+
+    lanes_domain_type keyed_lanes;
+    for (unsigned w = 0; w < N; ++w) {
+        keyed_lanes[w] = vector_type{} + keyed[w];
+    }
+    keyed_lanes[0] += lane_index;
+
+    std::size_t i = 0;
+    for (; i + Lanes <= nblocks; i += Lanes, out += Lanes * N) {
+        lanes_domain_type c(keyed_lanes);
+        c[0] += Uint(i);
+
+        rounds_functor<R, R, Uint, lanes_domain_type, Constants, N> func;
+        func(ks, c);
+
+        for (unsigned w = 0; w < N; ++w) {
+            std::memcpy(transposed[w], &c[w], sizeof(vector_type));
+        }
+        for (unsigned lane = 0; lane < Lanes; ++lane) {
+            for (unsigned w = 0; w < N; ++w) {
+                out[lane * N + w] = transposed[w][lane];
+            }
+        }
+    }
+
+    utils::array<Uint, N> tail_keyed(keyed);
+    tail_keyed[0] += Uint(i);
+    threefry_run_scalar<N, Uint, R, Constants>(ks, tail_keyed, out,
+                                               nblocks - i);
+}
+
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+ALEA_TARGET_AVX2 ALEA_FLATTEN inline void
+threefry_run_avx2(const utils::array<Uint, N + 1> &ks,
+                  const utils::array<Uint, N> &keyed, Uint *out,
+                  std::size_t nblocks) {
+    threefry_run_lanes<simd_lanes<Uint, 32>(), N, Uint, R, Constants>(
+        ks, keyed, out, nblocks);
+}
+
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+ALEA_TARGET_AVX512 ALEA_FLATTEN inline void
+threefry_run_avx512(const utils::array<Uint, N + 1> &ks,
+                    const utils::array<Uint, N> &keyed, Uint *out,
+                    std::size_t nblocks) {
+    threefry_run_lanes<simd_lanes<Uint, 64>(), N, Uint, R, Constants>(
+        ks, keyed, out, nblocks);
+}
+
+#endif
+
+} // namespace impl
+
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+inline void threefry<N, Uint, R, Constants>::encrypt_blocks(
+    impl::simd_isa isa, const domain_type &counter, uint_type *out,
+    std::size_t nblocks) const {
+    const utils::array<uint_type, N + 1> ks = key_schedule();
+    domain_type ctr(counter);
+
+    while (nblocks > 0) {
+        const std::size_t run = impl::counter_run(ctr, nblocks);
+
+        domain_type keyed;
+        utils::transform(ctr.begin(), ctr.end(), k.begin(), keyed.begin(),
+                         utils::plus<uint_type>());
+
+        switch (isa) {
+#ifdef ALEA_SIMD_X86
+        case impl::simd_isa::avx512:
+            impl::threefry_run_avx512<N, Uint, R, Constants>(ks, keyed, out,
+                                                             run);
+            break;
+        case impl::simd_isa::avx2:
+            impl::threefry_run_avx2<N, Uint, R, Constants>(ks, keyed, out,
+                                                           run);
+            break;
+#endif
+        default:
+            impl::threefry_run_scalar<N, Uint, R, Constants>(ks, keyed, out,
+                                                             run);
+        }
+
+        impl::counter_add(ctr, run);
+        out += run * N;
+        nblocks -= run;
+    }
+}
+
+} // namespace alea
+
+#endif // _ALEA_THREEFRY_SIMD_IMPL_HPP_
@@ -0,0 +1,336 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_JUMP_HPP_
+#define _ALEA_JUMP_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+#include "counter_engine.hpp"
+#include "impl/gf2_polynomial.hpp"
+
+///
+/// alea::jump(engine, n) advances any random engine by n values
+///
+///  - std::linear_congruential_engine ( minstd_rand, ... ): O(log n)
+///    modular exponentiation of the affine transition
+///  - std::mersenne_twister_engine ( mt19937, mt19937_64 ): O(log n)
+///    polynomial jump, see impl/gf2_polynomial.hpp
+///  - engines with an advance(n) member ( pcg64_dxsm ): advance(n)
+///  - the other engines: discard(n), which is O(1) for counter_engine,
+///    O(log n) for xoshiro256ss and linear for the others ( ranlux )
+///
+/// jump is a customization point: called unqualified after
+/// "using alea::jump;", it also finds the overloads declared in the
+/// namespace of a user engine. random_engine_mapper uses it this way
+///
+
+namespace alea {
+
+namespace impl {
+
+template <typename Engine, typename Arg>
+Arg advance_argument(void (Engine::*)(Arg));
+
+template <typename Engine, typename = void>
+struct has_advance : std::false_type {
+    typedef unsigned long long argument_type;
+};
+
+/// true if Engine provides an advance(n) member,
+/// argument_type is the type of n, or of discard(n) otherwise
+template <typename Engine>
+struct has_advance<Engine, std::void_t<decltype(advance_argument(
+                               &Engine::advance))>> : std::true_type {
+    typedef decltype(advance_argument(&Engine::advance)) argument_type;
+};
+
+/// advance engine by steps with calls to advance() or discard(),
+/// split in chunks of the integer type they accept
+template <typename Engine, typename UInt>
+inline void jump_by_chunks(Engine &engine, UInt steps) {
+    typedef typename has_advance<Engine>::argument_type argument_type;
+    constexpr UInt chunk =
+        counter_digits<UInt>() <= counter_digits<argument_type>()
+            ? ~UInt(0)
+            : UInt(~argument_type(0));
+
+    for (;;) {
+        const UInt step = steps > chunk ? chunk : steps;
+        if constexpr (has_advance<Engine>::value) {
+            engine.advance(argument_type(step));
+        } else {
+            engine.discard(argument_type(step));
+        }
+        steps -= step;
+        if (steps == 0) {
+            return;
+        }
+    }
+}
+
+/// a * b mod m, m == 0 stands for 2^digits of UInt
+template <typename UInt, UInt m>
+inline UInt jump_mulmod(UInt a, UInt b) {
+    if constexpr (m == 0) {
+        return UInt(std::uintmax_t(a) * b);
+    } else {
+#ifdef __SIZEOF_INT128__
+        return UInt((__uint128_t(a) * b) % m);
+#else
+        static_assert(std::numeric_limits<UInt>::digits <= 32,
+                      "128 bits integers required for this modulus");
+        return UInt((std::uint64_t(a) * b) % m);
+#endif
+    }
+}
+
+template <typename UInt, UInt m> inline UInt jump_addmod(UInt a, UInt b) {
+    if constexpr (m == 0) {
+        return UInt(a + b);
+    } else {
+        return UInt(a >= m - b ? a - (m - b) : a + b);
+    }
+}
+
+/// parameters of the n-th power of the transition of a mersenne twister
+template <typename UInt, std::size_t w, std::size_t n, std::size_t m,
+          std::size_t r, UInt a, std::size_t u, UInt d, std::size_t s, UInt b,
+          std::size_t t, UInt c, std::size_t l, UInt f>
+struct mersenne_twister_jump {
+    typedef std::mersenne_twister_engine<UInt, w, n, m, r, a, u, d, s, b, t,
+                                         c, l, f>
+        engine_type;
+
+    static constexpr std::size_t degree = n * w - r;
+    typedef gf2_polynomial<degree> polynomial_type;
+
+    static constexpr UInt word_mask =
+        w == std::numeric_limits<UInt>::digits ? ~UInt(0)
+                                               : (UInt(1) << w) - 1;
+    static constexpr UInt lower_mask = (UInt(1) << r) - 1;
+    static constexpr UInt upper_mask = word_mask & ~lower_mask;
+
+    /// x ^= (x >> shift) & mask, inverted
+    static UInt untemper_right(UInt y, std::size_t shift, UInt mask) {
+        UInt x = y;
+        for (std::size_t i = 0; i * shift < w; ++i) {
+            x = y ^ ((x >> shift) & mask);
+        }
+        return x;
+    }
+
+    /// x ^= (x << shift) & mask, inverted
+    static UInt untemper_left(UInt y, std::size_t shift, UInt mask) {
+        UInt x = y;
+        for (std::size_t i = 0; i * shift < w; ++i) {
+            x = y ^ ((x << shift) & mask & word_mask);
+        }
+        return x;
+    }
+
+    /// state word of an output of the engine
+    static UInt untemper(UInt y) {
+        y = untemper_right(y, l, word_mask);
+        y = untemper_left(y, t, c);
+        y = untemper_left(y, s, b);
+        return untemper_right(y, u, d);
+    }
+
+    /// extend the sequence of state words by count words
+    static void generate(std::vector<UInt> &x, std::size_t count) {
+        for (std::size_t k = x.size() - n; count > 0; ++k, --count) {
+            const UInt y = (x[k] & upper_mask) | (x[k + 1] & lower_mask);
+            x.push_back(x[k + m] ^ (y >> 1) ^ ((y & 1) ? a : UInt(0)));
+        }
+    }
+
+    /// characteristic polynomial of the transition, computed once
+    static const gf2_modular<degree> &modular() {
+        static const gf2_modular<degree> res = []() {
+            // the first output carries the non linear part of the seed
+            engine_type e;
+            e.discard(1);
+            std::vector<std::uint8_t> sequence(2 * degree);
+            for (std::uint8_t &bit : sequence) {
+                bit = std::uint8_t(e() & 1);
+            }
+            return gf2_modular<degree>(
+                gf2_berlekamp_massey<degree>(sequence));
+        }();
+        return res;
+    }
+
+    /// jump by steps > n values
+    static void jump(engine_type &e, counter_wide_uint steps) {
+        // the next n words of the sequence, from the outputs of a copy
+        engine_type copy(e);
+        std::vector<UInt> x(n);
+        for (UInt &word : x) {
+            word = untemper(UInt(copy()));
+        }
+
+        // the words from x_1 are in the linear space of characteristic
+        // polynomial P: x_(1 + e + i) = sum_j coef_j(x^e mod P) x_(1 + j + i)
+        // the state is the window of the n words before the next output
+        const counter_wide_uint exponent = steps - n - 1;
+        const std::array<std::uint64_t, 2> exponent_words = {
+            {std::uint64_t(exponent), std::uint64_t(exponent >> 32 >> 32)}};
+
+        // partitions jump repeatedly by the same stride: keep the last
+        // polynomial of the thread
+        thread_local std::array<std::uint64_t, 2> cached_exponent = {{0, 0}};
+        thread_local polynomial_type coefs = {{1}};
+        if (cached_exponent != exponent_words) {
+            coefs = modular().pow_x(exponent_words);
+            cached_exponent = exponent_words;
+        }
+
+        x.reserve(degree + 2 * n);
+        generate(x, degree + n);
+
+        std::vector<UInt> window(n, 0);
+        for (std::size_t j = 0; j < degree; ++j) {
+            if (gf2_coefficient<degree>(coefs, j)) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    window[i] ^= x[1 + j + i];
+                }
+            }
+        }
+
+        // standard textual representation: x_(i - n) ... x_(i - 1),
+        // followed by the position for implementations that store it
+        std::stringstream state;
+        for (UInt word : window) {
+            state << word << ' ';
+        }
+        state << n;
+        state >> e;
+    }
+};
+
+} // namespace impl
+
+/// advance engine by n values, n being any integer type including
+/// __uint128_t, a negative n throws std::invalid_argument
+template <typename Engine, typename Integer>
+inline typename std::enable_if<impl::is_jump_integer<Integer>::value>::type
+jump(Engine &engine, Integer n) {
+    typedef typename impl::is_jump_integer<Integer>::unsigned_type UInt;
+    impl::check_skip(n);
+    const UInt steps = static_cast<UInt>(n);
+    if (steps != 0) {
+        impl::jump_by_chunks(engine, steps);
+    }
+}
+
+/// O(1) jump of a counter_engine
+template <typename CBRNG, typename Integer>
+inline typename std::enable_if<impl::is_jump_integer<Integer>::value>::type
+jump(counter_engine<CBRNG> &engine, Integer n) {
+    engine.discard(n);
+}
+
+/// true if jump(engine, n) runs in constant time for engines of type Engine
+template <typename Engine> struct has_constant_jump : std::false_type {};
+
+template <typename CBRNG>
+struct has_constant_jump<counter_engine<CBRNG>> : std::true_type {};
+
+/// O(log n) jump of a linear congruential engine:
+/// x_n = a^n x + c (a^n - 1) / (a - 1) mod m
+template <typename UInt, UInt a, UInt c, UInt m, typename Integer>
+inline typename std::enable_if<impl::is_jump_integer<Integer>::value>::type
+jump(std::linear_congruential_engine<UInt, a, c, m> &engine, Integer n) {
+    typedef typename impl::is_jump_integer<Integer>::unsigned_type Steps;
+    impl::check_skip(n);
+    Steps steps = static_cast<Steps>(n);
+
+    // square and multiply on the affine transition x -> mult * x + plus
+    UInt acc_mult = 1, acc_plus = 0;
+    UInt cur_mult = a, cur_plus = c;
+    if constexpr (m != 0) {
+        cur_mult %= m;
+        cur_plus %= m;
+    }
+    for (; steps > 0; steps >>= 1) {
+        if (steps & 1) {
+            acc_mult = impl::jump_mulmod<UInt, m>(acc_mult, cur_mult);
+            acc_plus = impl::jump_addmod<UInt, m>(
+                impl::jump_mulmod<UInt, m>(acc_plus, cur_mult), cur_plus);
+        }
+        cur_plus = impl::jump_mulmod<UInt, m>(
+            impl::jump_addmod<UInt, m>(cur_mult, 1), cur_plus);
+        cur_mult = impl::jump_mulmod<UInt, m>(cur_mult, cur_mult);
+    }
+
+    // the textual representation is the state x
+    std::stringstream state;
+    state << engine;
+    UInt x = 0;
+    state >> x;
+    engine.seed(impl::jump_addmod<UInt, m>(
+        impl::jump_mulmod<UInt, m>(acc_mult, x), acc_plus));
+}
+
+/// O(log n) jump of a mersenne twister engine, the characteristic
+/// polynomial is computed on the first use for each engine type
+///
+/// Short jumps, cheaper than a few polynomial products, use discard
+template <typename UInt, std::size_t w, std::size_t n, std::size_t m,
+          std::size_t r, UInt a, std::size_t u, UInt d, std::size_t s, UInt b,
+          std::size_t t, UInt c, std::size_t l, UInt f, typename Integer>
+inline typename std::enable_if<impl::is_jump_integer<Integer>::value>::type
+jump(std::mersenne_twister_engine<UInt, w, n, m, r, a, u, d, s, b, t, c, l,
+                                  f> &engine,
+     Integer steps) {
+    typedef impl::mersenne_twister_jump<UInt, w, n, m, r, a, u, d, s, b, t, c,
+                                        l, f>
+        jump_type;
+    typedef typename impl::is_jump_integer<Integer>::unsigned_type Steps;
+    impl::check_skip(steps);
+    const impl::counter_wide_uint n_steps = static_cast<Steps>(steps);
+
+    constexpr impl::counter_wide_uint discard_limit = 1 << 20;
+    if (n_steps <= discard_limit) {
+        engine.discard(static_cast<unsigned long long>(n_steps));
+        return;
+    }
+    jump_type::jump(engine, n_steps);
+}
+
+} // namespace alea
+
+#endif // _ALEA_JUMP_HPP_
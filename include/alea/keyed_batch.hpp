@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_KEYED_BATCH_HPP_
+#define _ALEA_KEYED_BATCH_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "impl/simd_dispatch.hpp"
+#include "threefry.hpp"
+
+///
+/// keyed_batch encrypts one counter per key for a large set of keys
+///
+/// It is the "random number of the particle k at the step t" pattern:
+/// each entity has its own key, and all of them are evaluated at once
+///
+///    keyed_batch<threefry4x64> batch(keys.data(), keys.size());
+///    batch({{t, 0, 0, 0}}, out.data()); // out[k] = threefry(keys[k])(t)
+///
+/// The generic version keeps one cipher per key. The threefry
+/// specialization caches the expanded key schedules in a structure of
+/// arrays and computes several entities per SIMD register, one entity
+/// per lane
+///
+
+namespace alea {
+
+template <typename CBRNG> class keyed_batch {
+  public:
+    typedef CBRNG cbrng_type;
+    typedef typename CBRNG::domain_type domain_type;
+    typedef typename CBRNG::range_type range_type;
+    typedef typename CBRNG::key_type key_type;
+
+    explicit keyed_batch() : ciphers() {}
+
+    /// batch of the n keys starting at keys
+    explicit keyed_batch(const key_type *keys, std::size_t n)
+        : ciphers(keys, keys + n) {}
+
+    std::size_t size() const { return ciphers.size(); }
+
+    /// out[i] = cipher(keys[i])(counter) for every key of the batch
+    void operator()(const domain_type &counter, range_type *out) const {
+        encrypt(&counter, 0, out);
+    }
+
+    /// out[i] = cipher(keys[i])(counters[i]) for every key of the batch
+    void operator()(const domain_type *counters, range_type *out) const {
+        encrypt(counters, 1, out);
+    }
+
+    /// out[i] = cipher(keys[i])(counters[i * counter_stride])
+    void encrypt(const domain_type *counters, std::size_t counter_stride,
+                 range_type *out) const {
+        for (std::size_t i = 0; i < ciphers.size(); ++i) {
+            out[i] = ciphers[i](counters[i * counter_stride]);
+        }
+    }
+
+  private:
+    std::vector<cbrng_type> ciphers;
+};
+
+template <unsigned N, typename Uint, unsigned R, typename Constants>
+class keyed_batch<threefry<N, Uint, R, Constants>> {
+  public:
+    typedef threefry<N, Uint, R, Constants> cbrng_type;
+    typedef typename cbrng_type::domain_type domain_type;
+    typedef typename cbrng_type::range_type range_type;
+    typedef typename cbrng_type::key_type key_type;
+    typedef Uint uint_type;
+
+    explicit keyed_batch() : n_keys(0), stride(0), schedules() {}
+
+    /// batch of the n keys starting at keys
+    explicit keyed_batch(const key_type *keys, std::size_t n)
+        : n_keys(n), stride(padded_size(n)), schedules((N + 1) * stride) {
+        for (std::size_t i = 0; i < n; ++i) {
+            uint_type parity = impl::uint_ks_parity<Uint>();
+            for (unsigned w = 0; w < N; ++w) {
+                schedules[w * stride + i] = keys[i][w];
+                parity ^= keys[i][w];
+            }
+            schedules[N * stride + i] = parity;
+        }
+    }
+
+    std::size_t size() const { return n_keys; }
+
+    /// out[i] = threefry(keys[i])(counter) for every key of the batch
+    void operator()(const domain_type &counter, range_type *out) const {
+        encrypt(impl::simd_isa_best(), &counter, 0, out);
+    }
+
+    /// out[i] = threefry(keys[i])(counters[i]) for every key of the batch
+    void operator()(const domain_type *counters, range_type *out) const {
+        encrypt(impl::simd_isa_best(), counters, 1, out);
+    }
+
+    /// out[i] = threefry(keys[i])(counters[i * counter_stride])
+    /// with an explicit kernel selection
+    void encrypt(impl::simd_isa isa, const domain_type *counters,
+                 std::size_t counter_stride, range_type *out) const;
+
+  private:
+    /// number of entities rounded up to the widest SIMD register
+    static std::size_t padded_size(std::size_t n) {
+        constexpr std::size_t lanes = 64 / sizeof(Uint);
+        return (n + lanes - 1) / lanes * lanes;
+    }
+
+    std::size_t n_keys;
+    std::size_t stride;
+    // key schedule word w of the entity i at schedules[w * stride + i]
+    std::vector<uint_type> schedules;
+};
+
+} // namespace alea
+
+#include "impl/keyed_batch_simd_impl.hpp"
+
+#endif // _ALEA_KEYED_BATCH_HPP_
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_MONTE_CARLO_HPP_
+#define _ALEA_MONTE_CARLO_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "counter_engine.hpp"
+#include "impl/block_counter.hpp"
+#include "thread_pool.hpp"
+#include "threefry.hpp"
+
+///
+/// alea::monte_carlo(n_samples, kernel, reduction) reduces
+/// kernel(i, engine) over the samples i in [0, n_samples) on a
+/// thread_pool, with a result independent of the number of threads and
+/// of the scheduling
+///
+///    // estimate of pi
+///    const double inside = alea::monte_carlo(
+///        n, [](std::uint64_t, auto &engine) {
+///            std::uniform_real_distribution<double> dist;
+///            const double x = dist(engine), y = dist(engine);
+///            return x * x + y * y < 1 ? 1.0 : 0.0;
+///        }, std::plus<double>());
+///
+/// The engine given to sample i is counter_engine<CBRNG>(key, ctr_i)
+/// where ctr_i holds i in its upper half, below the domain field of the
+/// counter: each sample owns a region of 2^( half of the counter bits )
+/// blocks, addressed from i only. The regions are tagged with their own
+/// domain ( see impl/block_counter.hpp ) and never meet the key API nor
+/// the streams of the engines of the key: CBRNG needs a counter of 128
+/// bits or more. At most 2^( half of the counter bits - 8 ) samples fit.
+///
+/// The samples are cut in chunks of grain samples, handed to the threads
+/// from an atomic counter as they get free. Chunks and partial results are
+/// combined by a pairwise reduction whose tree only depends on n_samples
+/// and grain, so floating point sums are bitwise reproducible.
+///
+/// kernel is called concurrently, reduction must be associative up to
+/// rounding, the result type default constructible.
+///
+
+namespace alea {
+
+namespace impl {
+
+/// samples per chunk
+constexpr std::size_t monte_carlo_grain = 1024;
+
+/// samples reduced sequentially at the leaves of the pairwise tree
+constexpr std::size_t monte_carlo_leaf = 8;
+
+/// number of samples addressable by the counter type Ctr, inclusive
+template <typename Ctr> constexpr std::uint64_t monte_carlo_max_samples() {
+    constexpr std::size_t bits = counter_bits<Ctr>() - counter_bits<Ctr>() / 2 -
+                                 counter_domain_bits<Ctr>();
+    return bits >= 64 ? std::numeric_limits<std::uint64_t>::max()
+                      : std::uint64_t(1) << bits;
+}
+
+/// counter of the region of sample: sample in the upper half
+/// and the monte_carlo domain tag
+template <typename Ctr> inline Ctr monte_carlo_counter(std::uint64_t sample) {
+    static_assert(counter_domain_bits<Ctr>() != 0,
+                  "the counter of the cbrng is too small for monte_carlo");
+
+    Ctr ctr{};
+    counter_or_bits(ctr, counter_bits<Ctr>() / 2, sample);
+    counter_set_domain(ctr, counter_domain_monte_carlo);
+    return ctr;
+}
+
+/// pairwise reduction of the samples [first, last)
+template <typename Result, typename CBRNG, typename Kernel,
+          typename Reduction>
+inline Result monte_carlo_samples(std::uint64_t first, std::uint64_t last,
+                                  Kernel &kernel, Reduction &reduction,
+                                  const typename CBRNG::key_type &key) {
+    typedef counter_engine<CBRNG> engine_type;
+    typedef typename engine_type::ctr_type ctr_type;
+
+    if (last - first <= monte_carlo_leaf) {
+        engine_type engine(key, monte_carlo_counter<ctr_type>(first));
+        Result res = kernel(first, engine);
+        for (std::uint64_t i = first + 1; i < last; ++i) {
+            engine_type sample(key, monte_carlo_counter<ctr_type>(i));
+            res = reduction(std::move(res), kernel(i, sample));
+        }
+        return res;
+    }
+
+    const std::uint64_t middle = first + (last - first) / 2;
+    Result left = monte_carlo_samples<Result, CBRNG>(first, middle, kernel,
+                                                     reduction, key);
+    return reduction(std::move(left),
+                     monte_carlo_samples<Result, CBRNG>(middle, last, kernel,
+                                                        reduction, key));
+}
+
+/// pairwise reduction of the partial results [first, last)
+template <typename Result, typename Reduction>
+inline Result monte_carlo_partials(std::vector<Result> &partials,
+                                   std::size_t first, std::size_t last,
+                                   Reduction &reduction) {
+    if (last - first == 1) {
+        return std::move(partials[first]);
+    }
+    const std::size_t middle = first + (last - first) / 2;
+    Result left = monte_carlo_partials(partials, first, middle, reduction);
+    return reduction(std::move(left),
+                     monte_carlo_partials(partials, middle, last, reduction));
+}
+
+} // namespace impl
+
+template <typename CBRNG = threefry_default, typename Kernel,
+          typename Reduction>
+inline auto
+monte_carlo(std::uint64_t n_samples, Kernel &&kernel, Reduction &&reduction,
+            const typename CBRNG::key_type &key = typename CBRNG::key_type(),
+            thread_pool &pool = default_thread_pool(),
+            std::size_t grain = impl::monte_carlo_grain) {
+    typedef counter_engine<CBRNG> engine_type;
+    typedef std::decay_t<std::invoke_result_t<Kernel &, std::uint64_t,
+                                              engine_type &>>
+        result_type;
+    static_assert(impl::counter_domain_bits<
+                      typename engine_type::ctr_type>() != 0,
+                  "the counter of the cbrng is too small for monte_carlo");
+
+    if (n_samples >
+        impl::monte_carlo_max_samples<typename engine_type::ctr_type>()) {
+        throw std::length_error("alea::monte_carlo: more samples than "
+                                "counter regions");
+    }
+    if (n_samples == 0) {
+        return result_type();
+    }
+
+    grain = std::max<std::size_t>(grain, 1);
+    const std::size_t n_chunks =
+        static_cast<std::size_t>((n_samples + grain - 1) / grain);
+    std::vector<result_type> partials(n_chunks);
+
+    pool.parallel_for(n_chunks, [&](std::size_t chunk) {
+        const std::uint64_t first = std::uint64_t(chunk) * grain;
+        const std::uint64_t last =
+            std::min<std::uint64_t>(first + grain, n_samples);
+        partials[chunk] = impl::monte_carlo_samples<result_type, CBRNG>(
+            first, last, kernel, reduction, key);
+    });
+
+    return impl::monte_carlo_partials(partials, 0, n_chunks, reduction);
+}
+
+} // namespace alea
+
+#endif // _ALEA_MONTE_CARLO_HPP_
@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_PARALLEL_FILL_HPP_
+#define _ALEA_PARALLEL_FILL_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<execution>)
+#include <execution>
+#endif
+
+#include "impl/engine_fill.hpp"
+#include "jump.hpp"
+#include "thread_pool.hpp"
+
+///
+/// alea::parallel_fill(engine, first, last, executor) writes the values
+/// of std::generate(first, last, std::ref(engine)) with several threads,
+/// and leaves engine where the serial fill would
+///
+/// The range is cut in chunks of whole counter blocks; each chunk copies
+/// the engine and jumps ( alea::jump, a discard for counter_engine ) to
+/// its offset, so the output does not depend on the number of threads.
+/// Engines without a fast jump ( O(n) discard ) gain nothing from it.
+/// The executor is an alea::thread_pool or a std::execution policy.
+///
+///    alea::counter_engine<alea::threefry4x64> engine(42);
+///    alea::thread_pool pool;
+///    alea::parallel_fill(engine, values.begin(), values.end(), pool);
+///
+
+namespace alea {
+
+namespace impl {
+
+/// minimal number of values given to a task
+constexpr std::size_t parallel_fill_grain = std::size_t(1) << 16;
+
+/// tasks per thread, to balance uneven threads
+constexpr std::size_t parallel_fill_tasks = 4;
+
+/// values per task for n values on concurrency threads, a multiple of
+/// the block size of Engine
+template <typename Engine>
+inline std::size_t parallel_fill_chunk(std::size_t n, std::size_t concurrency,
+                                       std::size_t grain) {
+    const std::size_t block = engine_block_size<Engine>::value;
+    const std::size_t tasks = concurrency * parallel_fill_tasks;
+    std::size_t chunk = std::max<std::size_t>((n + tasks - 1) / tasks, grain);
+    chunk = std::max<std::size_t>(chunk, 1);
+    return (chunk + block - 1) / block * block;
+}
+
+/// fill the task-th chunk of [first, first + n) from a copy of engine
+template <typename Engine, typename RandomIt>
+inline void parallel_fill_task(const Engine &engine, RandomIt first,
+                               std::size_t n, std::size_t chunk,
+                               std::size_t task) {
+    const std::size_t begin = task * chunk;
+    const std::size_t end = std::min(begin + chunk, n);
+
+    Engine local(engine);
+    jump(local, static_cast<std::uint64_t>(begin));
+    fill_serial(local, first + begin, end - begin);
+}
+
+} // namespace impl
+
+/// fill [first, last) on the threads of pool, each task writes at least
+/// grain values
+template <typename Engine, typename RandomIt>
+inline void parallel_fill(Engine &engine, RandomIt first, RandomIt last,
+                          thread_pool &pool,
+                          std::size_t grain = impl::parallel_fill_grain) {
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    const std::size_t chunk =
+        impl::parallel_fill_chunk<Engine>(n, pool.concurrency(), grain);
+    const std::size_t tasks = (n + chunk - 1) / chunk;
+
+    if (tasks <= 1) {
+        impl::fill_serial(engine, first, n);
+        return;
+    }
+
+    const Engine &origin = engine;
+    pool.parallel_for(tasks, [&](std::size_t task) {
+        impl::parallel_fill_task(origin, first, n, chunk, task);
+    });
+    jump(engine, static_cast<std::uint64_t>(n));
+}
+
+#if defined(__cpp_lib_execution)
+
+/// fill [first, last) with the std::execution policy policy
+template <typename Engine, typename RandomIt, typename ExecutionPolicy>
+inline std::enable_if_t<
+    std::is_execution_policy<std::decay_t<ExecutionPolicy>>::value>
+parallel_fill(Engine &engine, RandomIt first, RandomIt last,
+              ExecutionPolicy &&policy,
+              std::size_t grain = impl::parallel_fill_grain) {
+    const std::size_t n = static_cast<std::size_t>(std::distance(first, last));
+    const std::size_t chunk = impl::parallel_fill_chunk<Engine>(
+        n, thread_pool::default_concurrency(), grain);
+
+    std::vector<std::size_t> tasks((n + chunk - 1) / chunk);
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        tasks[i] = i;
+    }
+
+    const Engine &origin = engine;
+    std::for_each(std::forward<ExecutionPolicy>(policy), tasks.begin(),
+                  tasks.end(), [&](std::size_t task) {
+                      impl::parallel_fill_task(origin, first, n, chunk, task);
+                  });
+    jump(engine, static_cast<std::uint64_t>(n));
+}
+
+#endif
+
+} // namespace alea
+
+#endif // _ALEA_PARALLEL_FILL_HPP_
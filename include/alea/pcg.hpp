@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _ALEA_RANDOM_PCG_
+#define _ALEA_RANDOM_PCG_
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <type_traits>
+
+#include "impl/block_counter.hpp"
+#include "splitmix.hpp"
+#include "threefry.hpp"
+
+///
+///  pcg64_dxsm is the 128 bits LCG based generator of M. O'Neill
+///  "PCG: A Family of Simple Fast Space-Efficient Statistically Good
+///   Algorithms for Random Number Generation" (2014)
+///  with the DXSM output function and the 64 bits "cheap multiplier"
+///  of the numpy PCG64DXSM bit generator
+///
+///  128 bits of state and 2^127 selectable streams ( the increment ),
+///  period 2^128 per stream, passes BigCrush and PractRand
+///
+///  The LCG allows to jump ahead in O(log n) ( Brown, "Random number
+///  generation with arbitrary stride", 1994 ):
+///   - advance(n) / discard(n) advance by n steps
+///   - jump() advances by 2^64 steps, long_jump() by 2^96 steps
+///
+///  derivate(key) seeds a child engine, state and stream, from a
+///  threefry encryption of the parent state
+///
+///  pcg64_dxsm requires a compiler with 128 bits integers
+///
+
+#ifdef __SIZEOF_INT128__
+
+namespace alea {
+
+class pcg64_dxsm {
+  public:
+    typedef std::uint64_t result_type;
+    typedef __uint128_t uint128_type;
+
+    static constexpr result_type default_seed = 0;
+
+    static constexpr std::uint64_t cheap_multiplier =
+        UINT64_C(0xda942042e4dd58b5);
+
+    explicit pcg64_dxsm() { seed(); }
+
+    explicit pcg64_dxsm(result_type r) { seed(r); }
+
+    explicit pcg64_dxsm(std::seed_seq &seq) { seed(seq); }
+
+    /// engine of the given initial state and stream
+    /// ( same initialization than the numpy bit generator )
+    explicit pcg64_dxsm(uint128_type init_state, uint128_type init_stream) {
+        seed(init_state, init_stream);
+    }
+
+    pcg64_dxsm(const pcg64_dxsm &) = default;
+    pcg64_dxsm(pcg64_dxsm &&) = default;
+
+    pcg64_dxsm &operator=(const pcg64_dxsm &) = default;
+    pcg64_dxsm &operator=(pcg64_dxsm &&) = default;
+
+    void seed() { seed(default_seed); }
+
+    /// the initial state and stream are taken from the splitmix64
+    /// sequence of r
+    void seed(result_type r) {
+        std::uint64_t words[4];
+        for (std::uint64_t &w : words) {
+            r += impl::splitmix64_gamma;
+            w = impl::splitmix64_mix(r);
+        }
+        seed(make_uint128(words[0], words[1]),
+             make_uint128(words[2], words[3]));
+    }
+
+    void seed(uint128_type init_state, uint128_type init_stream) {
+        state = 0;
+        inc = (init_stream << 1) | 1;
+        step();
+        state += init_state;
+        step();
+    }
+
+    template <typename SeedSeq> void seed(SeedSeq &seq) {
+        std::array<std::uint32_t, 8> words;
+        seq.generate(words.begin(), words.end());
+        seed(make_uint128(words[0], words[1], words[2], words[3]),
+             make_uint128(words[4], words[5], words[6], words[7]));
+    }
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    inline result_type operator()() {
+        // DXSM output function of the state before the step
+        std::uint64_t hi = std::uint64_t(state >> 64);
+        const std::uint64_t lo = std::uint64_t(state) | 1;
+        hi ^= hi >> 32;
+        hi *= cheap_multiplier;
+        hi ^= hi >> 48;
+        hi *= lo;
+
+        step();
+        return hi;
+    }
+
+    /// skip n values in O(log n), n can be any integer type including
+    /// __uint128_t, a negative n throws std::invalid_argument
+    template <typename Integer>
+    typename std::enable_if<impl::is_jump_integer<Integer>::value>::type
+    discard(Integer n) {
+        typedef typename impl::is_jump_integer<Integer>::unsigned_type UInt;
+        impl::check_skip(n);
+        advance(uint128_type(static_cast<UInt>(n)));
+    }
+
+    /// advance the state by n steps in O(log n)
+    void advance(uint128_type n) {
+        uint128_type acc_mult = 1, acc_plus = 0;
+        uint128_type cur_mult = cheap_multiplier, cur_plus = inc;
+
+        for (; n > 0; n >>= 1) {
+            if (n & 1) {
+                acc_mult *= cur_mult;
+                acc_plus = acc_plus * cur_mult + cur_plus;
+            }
+            cur_plus = (cur_mult + 1) * cur_plus;
+            cur_mult *= cur_mult;
+        }
+        state = acc_mult * state + acc_plus;
+    }
+
+    /// advance the state by 2^64 steps
+    ///
+    /// it can be used to generate 2^64 non-overlapping subsequences
+    /// of 2^64 values of the same stream
+    void jump() { advance(uint128_type(1) << 64); }
+
+    /// advance the state by 2^96 steps
+    void long_jump() { advance(uint128_type(1) << 96); }
+
+    /// create an engine, on a different stream, independent of this one
+    /// for the given key
+    pcg64_dxsm derivate(result_type key) const {
+        const threefry4x64::key_type parent = {
+            {std::uint64_t(state), std::uint64_t(state >> 64),
+             std::uint64_t(inc), std::uint64_t(inc >> 64)}};
+        const threefry4x64 cipher(parent);
+        const threefry4x64::range_type block =
+            cipher({{key, UINT64_C(0x70636736345f), 0, 0}});
+
+        pcg64_dxsm res;
+        res.state = make_uint128(block[0], block[1]);
+        res.inc = make_uint128(block[2], block[3]) | 1;
+        return res;
+    }
+
+    uint128_type get_state() const { return state; }
+
+    uint128_type get_increment() const { return inc; }
+
+    friend bool operator==(const pcg64_dxsm &lhs, const pcg64_dxsm &rhs) {
+        return lhs.state == rhs.state && lhs.inc == rhs.inc;
+    }
+
+    friend bool operator!=(const pcg64_dxsm &lhs, const pcg64_dxsm &rhs) {
+        return !(lhs == rhs);
+    }
+
+    friend std::ostream &operator<<(std::ostream &os,
+                                    const pcg64_dxsm &engine) {
+        return os << std::uint64_t(engine.state >> 64) << " "
+                  << std::uint64_t(engine.state) << " "
+                  << std::uint64_t(engine.inc >> 64) << " "
+                  << std::uint64_t(engine.inc);
+    }
+
+    friend std::istream &operator>>(std::istream &is, pcg64_dxsm &engine) {
+        std::uint64_t words[4];
+        if (is >> words[0] >> words[1] >> words[2] >> words[3]) {
+            engine.state = make_uint128(words[1], words[0]);
+            engine.inc = make_uint128(words[3], words[2]);
+        }
+        return is;
+    }
+
+  private:
+    static inline uint128_type make_uint128(std::uint64_t lo,
+                                            std::uint64_t hi) {
+        return (uint128_type(hi) << 64) | lo;
+    }
+
+    static inline uint128_type make_uint128(std::uint32_t w0,
+                                            std::uint32_t w1,
+                                            std::uint32_t w2,
+                                            std::uint32_t w3) {
+        return make_uint128(std::uint64_t(w0) | std::uint64_t(w1) << 32,
+                            std::uint64_t(w2) | std::uint64_t(w3) << 32);
+    }
+
+    inline void step() { state = state * cheap_multiplier + inc; }
+
+    uint128_type state;
+    uint128_type inc;
+};
+
+// specialize random_engine_derivate
+// for pcg64_dxsm
+inline pcg64_dxsm random_engine_derivate(const pcg64_dxsm &engine,
+                                         const pcg64_dxsm::result_type &key) {
+    return engine.derivate(key);
+}
+
+} // namespace alea
+
+#endif
+
+#endif // _ALEA_RANDOM_PCG_
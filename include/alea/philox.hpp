@@ -0,0 +1,276 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+//
+// This work is derivated from the boost.Random123
+// repository accessible here https://github.com/DEShawResearch/Random123-Boost
+//
+//
+
+#ifndef _ALEA_RANDOM_PHILOX_
+#define _ALEA_RANDOM_PHILOX_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include "threefry.hpp"
+
+///
+///  philox is a state-less counter base random generator
+///  based on a reduced strength cryptographic bijection built
+///  with wide multiplications ( mulhilo )
+///
+///   philox has been presented at SC11 in the publication
+///
+/// "Parallel random numbers: as easy as 1, 2, 3".
+///    John K. Salmon, Mark A. Moraes, Ron O. Dror, David E. Shaw"
+///    (doi:10.1145/2063384.2063405)
+///
+///  It is often the fastest crush-resistant cbrng on CPUs
+///  with a fast wide multiplier
+///
+///  This implementation is freely inspired of Boost.Random123
+///  (https://github.com/DEShawResearch/Random123-Boost )
+///
+
+namespace alea {
+
+namespace impl {
+
+// The constants here are from Salmon et al .
+//
+// multipliers of the rounds and Weyl sequence increments
+// used to bump the key between rounds
+
+template <unsigned _N, typename Uint> struct philox_constants {};
+
+// 2x32 constants
+template <> struct philox_constants<2, uint32_t> {
+    static constexpr uint32_t multipliers[1] = {UINT32_C(0xD256D193)};
+    static constexpr uint32_t weyl[1] = {UINT32_C(0x9E3779B9)};
+};
+
+// 4x32 constants
+template <> struct philox_constants<4, uint32_t> {
+    static constexpr uint32_t multipliers[2] = {UINT32_C(0xD2511F53),
+                                                UINT32_C(0xCD9E8D57)};
+    static constexpr uint32_t weyl[2] = {UINT32_C(0x9E3779B9),
+                                         UINT32_C(0xBB67AE85)};
+};
+
+// 2x64 constants
+template <> struct philox_constants<2, uint64_t> {
+    static constexpr uint64_t multipliers[1] = {
+        UINT64_C(0xD2B74407B1CE6E93)};
+    static constexpr uint64_t weyl[1] = {UINT64_C(0x9E3779B97F4A7C15)};
+};
+
+// 4x64 constants
+template <> struct philox_constants<4, uint64_t> {
+    static constexpr uint64_t multipliers[2] = {UINT64_C(0xD2E7470EE14C6C93),
+                                                UINT64_C(0xCA5A826395121157)};
+    static constexpr uint64_t weyl[2] = {UINT64_C(0x9E3779B97F4A7C15),
+                                         UINT64_C(0xBB67AE8584CAA73B)};
+};
+
+/// full width product a * b, returned as ( high word, low word )
+inline void philox_mulhilo(uint32_t a, uint32_t b, uint32_t &hi,
+                           uint32_t &lo) {
+    const uint64_t product = uint64_t(a) * uint64_t(b);
+    hi = uint32_t(product >> 32);
+    lo = uint32_t(product);
+}
+
+inline void philox_mulhilo(uint64_t a, uint64_t b, uint64_t &hi,
+                           uint64_t &lo) {
+#ifdef __SIZEOF_INT128__
+    const __uint128_t product = __uint128_t(a) * __uint128_t(b);
+    hi = uint64_t(product >> 64);
+    lo = uint64_t(product);
+#else
+    const uint64_t mask = UINT64_C(0xFFFFFFFF);
+    const uint64_t a_lo = a & mask, a_hi = a >> 32;
+    const uint64_t b_lo = b & mask, b_hi = b >> 32;
+
+    const uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi;
+    const uint64_t hl = a_hi * b_lo, hh = a_hi * b_hi;
+    const uint64_t middle = (ll >> 32) + (lh & mask) + (hl & mask);
+
+    hi = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+    lo = a * b;
+#endif
+}
+
+/// the number of rounds is known at compile time
+/// we use the same recursive partial template specialization
+/// than for threefry ( see rounds_functor ) to unroll them
+///
+/// the key is bumped by the Weyl constants before each round
+/// except the first one
+template <std::uint64_t r_remain, std::uint64_t r_max, typename Uint,
+          typename Domain, typename Key, typename Constants, std::uint64_t N>
+struct philox_rounds_functor {
+    static_assert(N == 2 || N == 4, "number of words should be 2 or 4");
+};
+
+template <std::uint64_t r_remain, std::uint64_t r_max, typename Uint,
+          typename Domain, typename Key, typename Constants>
+struct philox_rounds_functor<r_remain, r_max, Uint, Domain, Key, Constants,
+                             4> {
+    typedef Uint uint_type;
+    typedef Domain domain_type;
+    typedef Key key_type;
+
+    inline void operator()(key_type &k, domain_type &c) {
+        if constexpr (r_remain != r_max) {
+            k[0] += Constants::weyl[0];
+            k[1] += Constants::weyl[1];
+        }
+
+        uint_type hi0, lo0, hi1, lo1;
+        philox_mulhilo(Constants::multipliers[0], c[0], hi0, lo0);
+        philox_mulhilo(Constants::multipliers[1], c[2], hi1, lo1);
+
+        c = {{uint_type(hi1 ^ c[1] ^ k[0]), lo1, uint_type(hi0 ^ c[3] ^ k[1]),
+              lo0}};
+
+        philox_rounds_functor<r_remain - 1, r_max, uint_type, domain_type,
+                              key_type, Constants, 4>
+            func;
+        func(k, c);
+    }
+};
+
+template <std::uint64_t r_max, typename Uint, typename Domain, typename Key,
+          typename Constants>
+struct philox_rounds_functor<0, r_max, Uint, Domain, Key, Constants, 4> {
+    typedef Domain domain_type;
+    typedef Key key_type;
+
+    inline void operator()(key_type &k, domain_type &c) {
+        (void)k;
+        (void)c;
+    }
+};
+
+template <std::uint64_t r_remain, std::uint64_t r_max, typename Uint,
+          typename Domain, typename Key, typename Constants>
+struct philox_rounds_functor<r_remain, r_max, Uint, Domain, Key, Constants,
+                             2> {
+    typedef Uint uint_type;
+    typedef Domain domain_type;
+    typedef Key key_type;
+
+    inline void operator()(key_type &k, domain_type &c) {
+        if constexpr (r_remain != r_max) {
+            k[0] += Constants::weyl[0];
+        }
+
+        uint_type hi, lo;
+        philox_mulhilo(Constants::multipliers[0], c[0], hi, lo);
+
+        c = {{uint_type(hi ^ k[0] ^ c[1]), lo}};
+
+        philox_rounds_functor<r_remain - 1, r_max, uint_type, domain_type,
+                              key_type, Constants, 2>
+            func;
+        func(k, c);
+    }
+};
+
+template <std::uint64_t r_max, typename Uint, typename Domain, typename Key,
+          typename Constants>
+struct philox_rounds_functor<0, r_max, Uint, Domain, Key, Constants, 2> {
+    typedef Domain domain_type;
+    typedef Key key_type;
+
+    inline void operator()(key_type &k, domain_type &c) {
+        (void)k;
+        (void)c;
+    }
+};
+
+} // namespace impl
+
+template <unsigned N, typename Uint, unsigned R = 10,
+          typename Constants = impl::philox_constants<N, Uint>>
+class philox {
+    static_assert(N == 2 || N == 4, "number of words should be 2 or 4");
+
+  public:
+    typedef utils::array<Uint, N> domain_type;
+    typedef utils::array<Uint, N> range_type;
+    typedef utils::array<Uint, N / 2> key_type;
+    typedef Uint uint_type;
+
+    explicit philox() : k() {}
+    explicit philox(key_type _k) : k(_k) {}
+
+    philox(const philox &) = default;
+    philox(philox &&) = default;
+
+    philox &operator=(const philox &) = default;
+    philox &operator=(philox &&) = default;
+
+    void set_key(key_type _k) { k = _k; }
+
+    key_type get_key() const { return k; }
+
+    bool operator==(const philox &rhs) const { return k == rhs.k; }
+    bool operator!=(const philox &rhs) const { return k != rhs.k; }
+
+    inline range_type operator()(const domain_type &counter) const {
+        using namespace impl;
+        key_type round_key(k);
+        domain_type c(counter);
+
+        philox_rounds_functor<R, R, uint_type, domain_type, key_type,
+                              Constants, N>
+            func;
+        func(round_key, c);
+
+        return c;
+    }
+
+  private:
+    key_type k;
+};
+
+typedef philox<2, std::uint32_t> philox2x32;
+typedef philox<4, std::uint32_t> philox4x32;
+
+typedef philox<2, std::uint64_t> philox2x64;
+typedef philox<4, std::uint64_t> philox4x64;
+
+} // namespace alea
+
+#endif // _ALEA_RANDOM_PHILOX_
@@ -29,7 +29,19 @@
 #ifndef _ALEA_RANDOM_HPP_
 #define _ALEA_RANDOM_HPP_
 
+#include "ars.hpp"
+#include "chacha.hpp"
+#include "compact_counter_engine.hpp"
 #include "counter_engine.hpp"
+#include "jump.hpp"
+#include "keyed_batch.hpp"
+#include "pcg.hpp"
+#include "philox.hpp"
+#include "random_key.hpp"
+#include "seed_seq.hpp"
+#include "splitmix.hpp"
+#include "squares.hpp"
 #include "threefry.hpp"
+#include "xoshiro.hpp"
 
 #endif // _ALEA_RANDOM_HPP_
@@ -30,12 +30,19 @@
 #define _ALEA_RANDOM_ENGINE_MAPPER_HPP_
 
 #include <algorithm>
+#include <array>
 #include <boost/integer.hpp>
 #include <boost/random.hpp>
 #include <cassert>
+#include <cstddef>
+#include <limits>
 #include <memory>
+#include <memory_resource>
+#include <type_traits>
 #include <vector>
 
+#include "impl/block_counter.hpp"
+
 namespace alea {
 
 // internals
@@ -50,11 +57,30 @@ template <typename Uint> class abstract_engine;
 /// Allow to abstract different random generators behind a single
 /// interface at runtime
 ///
+/// The values are produced by batches of buffer_size values, one virtual
+/// call per batch. The mapped engine runs at most one batch ahead of the
+/// values returned by the mapper, derivate() still gives the child of the
+/// engine at the position of the mapper, as without buffering: engines up
+/// to impl::mapper_snapshot_size bytes keep a copy of their state before
+/// the last batch, the larger engines of the generic derivation
+/// ( mersenne twister, ... ) are derivated from the buffered values
+///
+/// Engines up to InlineSize bytes are stored inside the mapper, without
+/// allocation. Larger engines are allocated from a memory resource, the
+/// default one or an arena / pool given at construction, that the copies
+/// and the derivated mappers reuse
 ///
-template <typename Uint> class random_engine_mapper {
+template <typename Uint, std::size_t InlineSize = 256>
+class random_engine_mapper {
   public:
     typedef Uint result_type;
 
+    /// number of values produced per call to the mapped engine
+    static constexpr std::size_t buffer_size = 64;
+
+    /// size of the inline storage of the mapped engine
+    static constexpr std::size_t inline_size = InlineSize;
+
     /// default constructor
     /// generate empty mapper
     explicit random_engine_mapper();
@@ -62,12 +88,28 @@ template <typename Uint> class random_engine_mapper {
     /// map a specialized random generator in the C++11 / boost format
     ///  to a generic random_engine_mapper that can be used in any distribution
     ///
-    template <typename Engine> explicit random_engine_mapper(Engine &&intern);
+    /// resource provides the memory of the engines that do not fit
+    /// in the inline storage
+    ///
+    template <typename Engine,
+              typename = typename std::enable_if<!std::is_same<
+                  typename std::decay<Engine>::type,
+                  random_engine_mapper>::value>::type>
+    explicit random_engine_mapper(
+        Engine &&intern,
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    /// copy the mapped engine and its buffered values
+    random_engine_mapper(const random_engine_mapper &other);
 
     random_engine_mapper(random_engine_mapper &&other);
 
+    random_engine_mapper &operator=(const random_engine_mapper &other);
+
     random_engine_mapper &operator=(random_engine_mapper &&);
 
+    ~random_engine_mapper();
+
     /// reset to defautl seed, mapping
     inline void seed();
 
@@ -77,6 +119,14 @@ template <typename Uint> class random_engine_mapper {
     /// generator operation
     result_type operator()();
 
+    /// write the n next values to out, the bulk path of the
+    /// mapped engine is used when it has one
+    void fill(result_type *out, std::size_t n);
+
+    /// skip the n next values, with the O(log n) or O(1) jump of the
+    /// mapped engine when it has one ( see alea::jump )
+    void discard(impl::counter_wide_uint n);
+
     /// derivate create a random engine
     ///  derivated from the current random engine
     ///  seed and the key.
@@ -87,24 +137,47 @@ template <typename Uint> class random_engine_mapper {
     ///  old one
     ///  - Two different keys, even close in range guarantee two independent
     ///  random streams
+    ///  - Two different positions of the mapper give two independent random
+    ///  streams
     ///
+    /// The child maps random_engine_derivate of the mapped engine at the
+    /// position of the mapper: with buffered values, the copy of the
+    /// engine before the batch is stepped to this position and derivated,
+    /// or the large engines are reseeded from the next buffered values
     ///
     random_engine_mapper derivate(result_type key) const;
 
+    /// true if the mapped engine is stored inline, without allocation
+    bool is_inline() const {
+        return _engine != nullptr &&
+               static_cast<const void *>(_engine) ==
+                   static_cast<const void *>(_storage);
+    }
+
     /// minimum value returned by engine
     /// map to minimum value of the type
-    static result_type min() { return std::numeric_limits<result_type>::min(); }
+    static constexpr result_type min() {
+        return std::numeric_limits<result_type>::min();
+    }
 
     /// minimum value returned by engine
     /// map to maximum value of the type
-    static result_type max() { return std::numeric_limits<result_type>::max(); }
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
 
   private:
-    std::unique_ptr<impl::abstract_engine<result_type>> _engine;
+    /// memory for an engine of size bytes and alignment align
+    void *allocate(std::size_t size, std::size_t align);
 
-    random_engine_mapper(const random_engine_mapper &other) = delete;
+    /// destroy the mapped engine and release its memory
+    void reset();
 
-    random_engine_mapper &operator=(const random_engine_mapper &other) = delete;
+    alignas(std::max_align_t) unsigned char _storage[InlineSize];
+    impl::abstract_engine<result_type> *_engine;
+    std::pmr::memory_resource *_resource;
+    std::array<result_type, buffer_size> _buffer;
+    std::size_t _pos;
 };
 
 typedef random_engine_mapper<boost::uint32_t> random_engine_mapper_32;
@@ -113,10 +186,10 @@ typedef random_engine_mapper<boost::uint64_t> random_engine_mapper_64;
 // specialize random_engine_derivate
 // for random mapper
 
-template <typename Uint>
-inline random_engine_mapper<Uint> random_engine_derivate(
-    const random_engine_mapper<Uint> &engine,
-    const typename random_engine_mapper<Uint>::result_type &key) {
+template <typename Uint, std::size_t InlineSize>
+inline random_engine_mapper<Uint, InlineSize> random_engine_derivate(
+    const random_engine_mapper<Uint, InlineSize> &engine,
+    const typename random_engine_mapper<Uint, InlineSize>::result_type &key) {
     return engine.derivate(key);
 }
 
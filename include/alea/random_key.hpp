@@ -0,0 +1,208 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_RANDOM_KEY_HPP_
+#define _ALEA_RANDOM_KEY_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include "counter_engine.hpp"
+#include "impl/block_counter.hpp"
+#include "keyed_batch.hpp"
+#include "threefry.hpp"
+
+///
+/// stateless key API in the style of JAX ( jax.random )
+///
+///  - split(key, n) gives n child keys
+///  - fold_in(key, data) gives the child key of key identified by data
+///  - random_bits(key, n) gives n random words
+///
+/// Everything is a single evaluation of the block function per output
+/// block, keyed by the parent key, and the bulk SIMD kernels of the
+/// cipher are used when several blocks are needed. The three operations
+/// use disjoint counter ranges: the most significant byte of the counter
+/// holds an operation tag ( the domain field of impl/block_counter.hpp ),
+/// the 64 lowest bits hold the child index, the data or the position
+///
+///    const auto children = alea::split(root, 1024);
+///    const auto task_key = alea::fold_in(children[3], task_id);
+///    alea::counter_engine<alea::threefry4x64> engine(task_key);
+///
+/// The tags 1, 2 and 3 of the domain byte are reserved to the key API.
+/// The stream of counter_engine(key) and the compact_counter_engine
+/// streams stay in the domain 0, so random_bits(key, n) is independent of
+/// all of them. The key API requires counters of at least 128 bits.
+///
+
+namespace alea {
+
+namespace impl {
+
+constexpr std::uint64_t random_key_split_tag = counter_domain_split;
+constexpr std::uint64_t random_key_fold_in_tag = counter_domain_fold_in;
+constexpr std::uint64_t random_key_bits_tag = counter_domain_random_bits;
+
+/// counter of the position index of the operation tag
+template <typename CBRNG>
+inline typename CBRNG::domain_type random_key_counter(std::uint64_t index,
+                                                      std::uint64_t tag) {
+    typedef typename CBRNG::domain_type domain_type;
+
+    // the tag goes in the domain field, the index below it
+    static_assert(counter_domain_bits<domain_type>() != 0 &&
+                      counter_bits<domain_type>() -
+                              counter_domain_bits<domain_type>() >=
+                          64,
+                  "the counter of the cbrng is too small for the key API");
+
+    domain_type ctr{};
+    counter_or_bits(ctr, 0, index);
+    counter_set_domain(ctr, tag);
+    return ctr;
+}
+
+/// write the n blocks of cipher from the position 0 of the operation tag
+/// to out, one block at a time through convert
+template <typename CBRNG, typename Convert>
+inline void random_key_blocks(const CBRNG &cipher, std::uint64_t tag,
+                              std::size_t n, Convert convert) {
+    typedef typename CBRNG::range_type range_type;
+    typedef typename CBRNG::uint_type uint_type;
+    constexpr std::size_t nelem = std::tuple_size<range_type>::value;
+    constexpr std::size_t chunk_blocks = 64;
+
+    uint_type buffer[chunk_blocks * nelem];
+    typename CBRNG::domain_type ctr = random_key_counter<CBRNG>(0, tag);
+
+    for (std::size_t i = 0; i < n;) {
+        const std::size_t m = std::min(n - i, chunk_blocks);
+        cbrng_blocks(cipher, ctr, buffer, m);
+        for (std::size_t j = 0; j < m; ++j, ++i) {
+            range_type block;
+            std::copy_n(buffer + j * nelem, nelem, block.begin());
+            convert(i, block);
+        }
+        counter_add(ctr, std::uint64_t(m));
+    }
+}
+
+} // namespace impl
+
+/// write the n child keys of key to children
+template <typename CBRNG = threefry_default>
+inline void split(const typename CBRNG::key_type &key,
+                  typename CBRNG::key_type *children, std::size_t n) {
+    typedef typename CBRNG::key_type key_type;
+
+    impl::random_key_blocks(
+        CBRNG(key), impl::random_key_split_tag, n,
+        [children](std::size_t i, const typename CBRNG::range_type &block) {
+            children[i] = impl::resize_array<key_type>(block);
+        });
+}
+
+/// the n child keys of key
+template <typename CBRNG = threefry_default>
+inline std::vector<typename CBRNG::key_type>
+split(const typename CBRNG::key_type &key, std::size_t n) {
+    std::vector<typename CBRNG::key_type> children(n);
+    split<CBRNG>(key, children.data(), n);
+    return children;
+}
+
+/// split the nkeys keys at once: the child i of keys[k] is written
+/// to children[k * n + i] and is the same than split(keys[k], n)[i]
+///
+/// Each child index is computed for all the keys in a single
+/// keyed_batch pass, vectorized across the keys
+template <typename CBRNG = threefry_default>
+inline void split(const typename CBRNG::key_type *keys, std::size_t nkeys,
+                  std::size_t n, typename CBRNG::key_type *children) {
+    typedef typename CBRNG::key_type key_type;
+
+    const keyed_batch<CBRNG> batch(keys, nkeys);
+    std::vector<typename CBRNG::range_type> blocks(nkeys);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        batch(impl::random_key_counter<CBRNG>(i, impl::random_key_split_tag),
+              blocks.data());
+        for (std::size_t k = 0; k < nkeys; ++k) {
+            children[k * n + i] = impl::resize_array<key_type>(blocks[k]);
+        }
+    }
+}
+
+/// child key of key identified by data
+template <typename CBRNG = threefry_default>
+inline typename CBRNG::key_type fold_in(const typename CBRNG::key_type &key,
+                                        std::uint64_t data) {
+    const CBRNG cipher(key);
+    return impl::resize_array<typename CBRNG::key_type>(cipher(
+        impl::random_key_counter<CBRNG>(data, impl::random_key_fold_in_tag)));
+}
+
+/// write the n first random words of key to out
+///
+/// random_bits(key, m) is a prefix of random_bits(key, n) for m < n
+template <typename CBRNG = threefry_default>
+inline void random_bits(const typename CBRNG::key_type &key,
+                        typename CBRNG::uint_type *out, std::size_t n) {
+    constexpr std::size_t nelem =
+        std::tuple_size<typename CBRNG::range_type>::value;
+    const CBRNG cipher(key);
+    const std::size_t nblocks = n / nelem;
+
+    typename CBRNG::domain_type ctr =
+        impl::random_key_counter<CBRNG>(0, impl::random_key_bits_tag);
+    impl::cbrng_blocks(cipher, ctr, out, nblocks);
+
+    if (n % nelem != 0) {
+        impl::counter_add(ctr, std::uint64_t(nblocks));
+        const typename CBRNG::range_type block = cipher(ctr);
+        std::copy_n(block.begin(), n % nelem, out + nblocks * nelem);
+    }
+}
+
+/// the n first random words of key
+template <typename CBRNG = threefry_default>
+inline std::vector<typename CBRNG::uint_type>
+random_bits(const typename CBRNG::key_type &key, std::size_t n) {
+    std::vector<typename CBRNG::uint_type> bits(n);
+    random_bits<CBRNG>(key, bits.data(), n);
+    return bits;
+}
+
+} // namespace alea
+
+#endif // _ALEA_RANDOM_KEY_HPP_
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_SEED_SEQ_HPP_
+#define _ALEA_SEED_SEQ_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "threefry.hpp"
+
+///
+/// threefry_seed_seq is a seed sequence ( C++11 SeedSequence ) whose
+/// generate() writes the threefry4x64 stream of a 256 bits key
+///
+/// std::seed_seq mixes its whole output range several times, this one
+/// costs one block per 8 words: seeding a mersenne twister from a key
+/// is a single pass over its state
+///
+///    const alea::threefry_seed_seq::key_type key = {{1, 2, 3, 4}};
+///    alea::threefry_seed_seq seq(key);
+///    std::mt19937 engine;
+///    engine.seed(seq);
+///
+
+namespace alea {
+
+class threefry_seed_seq {
+  public:
+    typedef std::uint_least32_t result_type;
+    typedef threefry4x64::key_type key_type;
+
+    explicit threefry_seed_seq() : k() {}
+    explicit threefry_seed_seq(const key_type &key) : k(key) {}
+
+    /// the 32 bits words of the key, for std::seed_seq compatibility
+    template <typename InputIterator>
+    threefry_seed_seq(InputIterator first, InputIterator last) : k() {
+        for (std::size_t i = 0; first != last; ++first, ++i) {
+            k[(i / 2) % k.size()] ^= std::uint64_t(std::uint32_t(*first))
+                                     << (32 * (i % 2));
+        }
+    }
+
+    threefry_seed_seq(const threefry_seed_seq &) = delete;
+    threefry_seed_seq &operator=(const threefry_seed_seq &) = delete;
+
+    /// fill [first, last) with 32 bits words of the key stream
+    template <typename RandomAccessIterator>
+    void generate(RandomAccessIterator first, RandomAccessIterator last) const {
+        const threefry4x64 cipher(k);
+        threefry4x64::domain_type ctr = {{0, 0, 0, 0}};
+
+        while (first != last) {
+            const threefry4x64::range_type block = cipher(ctr);
+            ++ctr[0];
+            for (std::size_t i = 0; i < 2 * block.size() && first != last;
+                 ++i, ++first) {
+                *first = result_type(
+                    std::uint32_t(block[i / 2] >> (32 * (i % 2))));
+            }
+        }
+    }
+
+    /// number of 32 bits words of the key
+    std::size_t size() const { return 2 * k.size(); }
+
+    template <typename OutputIterator> void param(OutputIterator out) const {
+        for (std::size_t i = 0; i < size(); ++i, ++out) {
+            *out = result_type(std::uint32_t(k[i / 2] >> (32 * (i % 2))));
+        }
+    }
+
+    key_type get_key() const { return k; }
+
+  private:
+    key_type k;
+};
+
+} // namespace alea
+
+#endif // _ALEA_SEED_SEQ_HPP_
@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_SHARED_COUNTER_STREAM_HPP_
+#define _ALEA_SHARED_COUNTER_STREAM_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+
+#include "counter_engine.hpp"
+#include "impl/cache_line.hpp"
+
+///
+/// shared_counter_stream is one counter_engine stream consumed by many
+/// threads without locks
+///
+/// Each thread draws from its own local_stream, which leases LeaseBlocks
+/// counter blocks at a time with a single fetch_add on the shared block
+/// counter and encrypts them locally. The values of the blocks are the
+/// ones of counter_engine<CBRNG>(key) at the same positions: every value
+/// of the stream is drawn at most once, by one thread.
+///
+///    alea::shared_counter_stream<alea::threefry4x64> shared(key);
+///
+///    // in each thread
+///    auto stream = shared.local();
+///    std::uniform_real_distribution<double> dist;
+///    double x = dist(stream);
+///
+/// The lease counter sits alone on its cache line. The leasing statistics
+/// are kept by each local_stream and added to the shared ones when it is
+/// destroyed; a local_stream must not outlive its shared_counter_stream.
+///
+
+namespace alea {
+
+/// leasing statistics of a stream
+struct shared_stream_stats {
+    /// number of fetch_add on the shared counter
+    std::uint64_t leases = 0;
+    /// leases that did not follow the previous lease of the same thread:
+    /// another thread leased in between, the counter cache line moved
+    std::uint64_t interleaved = 0;
+};
+
+template <typename CBRNG, std::size_t LeaseBlocks = 64>
+class shared_counter_stream {
+    static_assert(LeaseBlocks > 0, "a lease holds at least one block");
+
+  public:
+    typedef CBRNG cbrng_type;
+    typedef typename CBRNG::key_type key_type;
+    typedef counter_engine<CBRNG> engine_type;
+    typedef typename engine_type::result_type result_type;
+
+    static constexpr std::size_t lease_blocks = LeaseBlocks;
+    static constexpr std::size_t block_size =
+        std::tuple_size<typename CBRNG::range_type>::value;
+
+    explicit shared_counter_stream(const key_type &key)
+        : _key(key), _next(0), _leases(0), _interleaved(0) {}
+
+    shared_counter_stream(const shared_counter_stream &) = delete;
+    shared_counter_stream &operator=(const shared_counter_stream &) = delete;
+
+    /// per thread view of the stream, a UniformRandomBitGenerator
+    class alignas(impl::cache_line_size) local_stream {
+      public:
+        typedef typename engine_type::result_type result_type;
+
+        explicit local_stream(shared_counter_stream &shared)
+            : _shared(&shared), _engine(shared._key), _end(0), _remaining(0),
+              _stats() {}
+
+        local_stream(local_stream &&other) noexcept
+            : _shared(other._shared), _engine(other._engine),
+              _end(other._end), _remaining(other._remaining),
+              _stats(other._stats) {
+            other._shared = nullptr;
+        }
+
+        local_stream(const local_stream &) = delete;
+        local_stream &operator=(const local_stream &) = delete;
+        local_stream &operator=(local_stream &&) = delete;
+
+        ~local_stream() {
+            if (_shared != nullptr) {
+                _shared->retire(_stats);
+            }
+        }
+
+        static constexpr result_type min() {
+            return std::numeric_limits<result_type>::min();
+        }
+
+        static constexpr result_type max() {
+            return std::numeric_limits<result_type>::max();
+        }
+
+        result_type operator()() {
+            if (_remaining == 0) {
+                lease();
+            }
+            --_remaining;
+            return _engine();
+        }
+
+        /// write the n next values of the stream to first, the leased
+        /// blocks are encrypted in bulk
+        template <typename OutputIterator>
+        OutputIterator generate_n(OutputIterator first, std::size_t n) {
+            while (n > 0) {
+                if (_remaining == 0) {
+                    lease();
+                }
+                const std::size_t count =
+                    n < _remaining ? n : static_cast<std::size_t>(_remaining);
+                first = _engine.generate_n(first, count);
+                _remaining -= count;
+                n -= count;
+            }
+            return first;
+        }
+
+        /// statistics of this stream only
+        shared_stream_stats stats() const { return _stats; }
+
+      private:
+        void lease() {
+            const std::uint64_t block = _shared->_next.fetch_add(
+                LeaseBlocks, std::memory_order_relaxed);
+
+            ++_stats.leases;
+            if (block != _end && _stats.leases > 1) {
+                ++_stats.interleaved;
+            }
+
+            // the engine is at the end of the previous lease, the
+            // counter only moves forward
+            _engine.discard((block - _end) * block_size);
+            _end = block + LeaseBlocks;
+            _remaining = LeaseBlocks * block_size;
+        }
+
+        shared_counter_stream *_shared;
+        engine_type _engine;
+        std::uint64_t _end;
+        std::uint64_t _remaining;
+        shared_stream_stats _stats;
+    };
+
+    local_stream local() { return local_stream(*this); }
+
+    /// number of blocks leased so far
+    std::uint64_t leased_blocks() const {
+        return _next.load(std::memory_order_relaxed);
+    }
+
+    /// statistics of the destroyed local streams
+    shared_stream_stats stats() const {
+        shared_stream_stats res;
+        res.leases = _leases.load(std::memory_order_relaxed);
+        res.interleaved = _interleaved.load(std::memory_order_relaxed);
+        return res;
+    }
+
+    key_type get_key() const { return _key; }
+
+  private:
+    void retire(const shared_stream_stats &stats) {
+        _leases.fetch_add(stats.leases, std::memory_order_relaxed);
+        _interleaved.fetch_add(stats.interleaved, std::memory_order_relaxed);
+    }
+
+    const key_type _key;
+    alignas(impl::cache_line_size) std::atomic<std::uint64_t> _next;
+    alignas(impl::cache_line_size) std::atomic<std::uint64_t> _leases;
+    std::atomic<std::uint64_t> _interleaved;
+};
+
+} // namespace alea
+
+#endif // _ALEA_SHARED_COUNTER_STREAM_HPP_
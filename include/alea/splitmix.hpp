@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _ALEA_RANDOM_SPLITMIX_
+#define _ALEA_RANDOM_SPLITMIX_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "threefry.hpp"
+
+///
+///  splitmix64 is the output function of the SplitMix generator
+///  of the Java JDK8 ( Steele, Lea, Flood, "Fast splittable pseudorandom
+///  number generators", OOPSLA 2014 ) used as a counter based generator
+///
+///  block n of the key k is  mix64(k + n * golden_gamma)
+///  which is exactly the n-th output of the usual splitmix64 sequence
+///  seeded with k
+///
+///  This is the fastest cbrng of alea ( one multiply-xorshift finalizer
+///  per 64 bits ) and passes BigCrush, but it is a hash and not a cipher:
+///  two keys that differ by a multiple of golden_gamma give shifted copies
+///  of the same stream. Use it for jitter, sampling decisions, randomized
+///  load balancing, not as a source of a large number of independent
+///  streams ( prefer squares, philox or threefry for that )
+///
+
+namespace alea {
+
+namespace impl {
+
+constexpr std::uint64_t splitmix64_gamma = UINT64_C(0x9E3779B97F4A7C15);
+
+/// splitmix64 finalizer ( variant 13 of the murmur3 64 bits finalizer )
+constexpr std::uint64_t splitmix64_mix(std::uint64_t z) {
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+} // namespace impl
+
+class splitmix64 {
+  public:
+    typedef utils::array<std::uint64_t, 1> domain_type;
+    typedef utils::array<std::uint64_t, 1> range_type;
+    typedef utils::array<std::uint64_t, 1> key_type;
+    typedef std::uint64_t uint_type;
+
+    explicit splitmix64() : k() {}
+    explicit splitmix64(key_type _k) : k(_k) {}
+
+    splitmix64(const splitmix64 &) = default;
+    splitmix64(splitmix64 &&) = default;
+
+    splitmix64 &operator=(const splitmix64 &) = default;
+    splitmix64 &operator=(splitmix64 &&) = default;
+
+    void set_key(key_type _k) { k = _k; }
+
+    key_type get_key() const { return k; }
+
+    bool operator==(const splitmix64 &rhs) const { return k == rhs.k; }
+    bool operator!=(const splitmix64 &rhs) const { return k != rhs.k; }
+
+    inline range_type operator()(const domain_type &counter) const {
+        return {{impl::splitmix64_mix(k[0] +
+                                      counter[0] * impl::splitmix64_gamma)}};
+    }
+
+    /// write the nblocks consecutive blocks starting at counter to out
+    inline void operator()(const domain_type &counter, uint_type *out,
+                           std::size_t nblocks) const {
+        std::uint64_t z = k[0] + counter[0] * impl::splitmix64_gamma;
+        for (std::size_t i = 0; i < nblocks; ++i) {
+            out[i] = impl::splitmix64_mix(z);
+            z += impl::splitmix64_gamma;
+        }
+    }
+
+  private:
+    key_type k;
+};
+
+} // namespace alea
+
+#endif // _ALEA_RANDOM_SPLITMIX_
@@ -0,0 +1,390 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_STREAM_LAYOUT_HPP_
+#define _ALEA_STREAM_LAYOUT_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "counter_engine.hpp"
+#include "impl/block_counter.hpp"
+
+///
+/// stream_layout maps hierarchical stream ids ( job, rank, thread,
+/// substream ... ) onto the key and the upper counter bits of a counter
+/// based engine: every process builds its own streams in O(1), without
+/// coordination, and two distinct ids never share a block within the
+/// 2^block_bits blocks of their streams
+///
+///    // 2^20 jobs, 2^16 ranks and 2^10 threads in the key,
+///    // 2^16 substreams in the counter
+///    typedef alea::stream_layout<alea::threefry4x64, alea::key_field<20>,
+///                                alea::key_field<16>, alea::key_field<10>,
+///                                alea::counter_field<16>>
+///        layout;
+///
+///    auto engine = layout::engine(seed, job, rank, thread, substream);
+///
+/// The fields are packed in declaration order from the most significant
+/// bit of the key, and from just below the domain field of the counter
+/// ( see impl/block_counter.hpp ), downward. The key bits left are taken
+/// from the seed, the counter bits left count the blocks of each stream
+/// ( block_bits ), at least min_block_bits so that no stream can run into
+/// the next one: counters of less than 128 bits, without domain field,
+/// leave no room for counter fields. The streams stay in the counter
+/// domain 0 and never meet split, fold_in, random_bits or monte_carlo for
+/// the same key.
+/// Ids wider than their field throw std::out_of_range.
+///
+/// key_tag / counter_tag are fields of constant value: two layouts with
+/// different tag values at the same bits can not produce the same stream,
+/// which streams_disjoint<LayoutA, LayoutB>() checks at compile time.
+///
+
+namespace alea {
+
+namespace impl {
+
+struct stream_field_info {
+    bool in_key;
+    bool is_tag;
+    unsigned bits;
+    std::uint64_t value;
+};
+
+/// total number of bits of an array of words
+template <typename Array> constexpr unsigned array_bits() {
+    return std::tuple_size<Array>::value *
+           std::numeric_limits<typename Array::value_type>::digits;
+}
+
+/// write the bits low bits of value at the bit position of words, bit 0
+/// is the least significant bit of the first word
+template <typename Array>
+constexpr void array_set_bits(Array &words, unsigned position, unsigned bits,
+                              std::uint64_t value) {
+    typedef typename Array::value_type word_type;
+    constexpr unsigned digits = std::numeric_limits<word_type>::digits;
+
+    while (bits > 0) {
+        const unsigned offset = position % digits;
+        const unsigned take = bits < digits - offset ? bits : digits - offset;
+        const word_type low =
+            take == digits ? word_type(~word_type(0))
+                           : word_type((word_type(1) << take) - 1);
+        const word_type mask = word_type(low << offset);
+
+        word_type &word = words[position / digits];
+        word = word_type((word & word_type(~mask)) |
+                         ((word_type(value) & low) << offset));
+
+        value = take < 64 ? value >> take : 0;
+        position += take;
+        bits -= take;
+    }
+}
+
+/// mask of the bits of the fields of a layout, and values of its tags,
+/// for the key or for the counter
+template <typename Array> struct stream_fixed_bits {
+    Array fields;
+    Array tag_mask;
+    Array tag_value;
+};
+
+} // namespace impl
+
+/// id of Bits bits in the key
+template <unsigned Bits> struct key_field {
+    static constexpr impl::stream_field_info info = {true, false, Bits, 0};
+};
+
+/// id of Bits bits in the upper counter bits
+template <unsigned Bits> struct counter_field {
+    static constexpr impl::stream_field_info info = {false, false, Bits, 0};
+};
+
+/// constant Value on Bits bits of the key
+template <unsigned Bits, std::uint64_t Value> struct key_tag {
+    static constexpr impl::stream_field_info info = {true, true, Bits, Value};
+};
+
+/// constant Value on Bits bits of the upper counter bits
+template <unsigned Bits, std::uint64_t Value> struct counter_tag {
+    static constexpr impl::stream_field_info info = {false, true, Bits,
+                                                     Value};
+};
+
+template <typename CBRNG, typename... Fields> class stream_layout {
+  public:
+    typedef CBRNG cbrng_type;
+    typedef counter_engine<CBRNG> engine_type;
+    typedef typename engine_type::key_type key_type;
+    typedef typename engine_type::ctr_type ctr_type;
+
+  private:
+    static constexpr std::size_t n_fields = sizeof...(Fields);
+
+    static constexpr std::array<impl::stream_field_info, n_fields> fields = {
+        {Fields::info...}};
+
+    static constexpr unsigned sum_bits(bool in_key) {
+        unsigned res = 0;
+        for (const impl::stream_field_info &field : fields) {
+            res += field.in_key == in_key ? field.bits : 0;
+        }
+        return res;
+    }
+
+    static constexpr std::size_t count_ids() {
+        std::size_t res = 0;
+        for (const impl::stream_field_info &field : fields) {
+            res += field.is_tag ? 0 : 1;
+        }
+        return res;
+    }
+
+    static constexpr bool valid_fields() {
+        for (const impl::stream_field_info &field : fields) {
+            if (field.bits == 0 || field.bits > 64 ||
+                (field.is_tag && field.bits < 64 &&
+                 (field.value >> field.bits) != 0)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  public:
+    /// number of ids given to key, counter and engine
+    static constexpr std::size_t n_ids = count_ids();
+
+    static constexpr unsigned key_field_bits = sum_bits(true);
+    static constexpr unsigned counter_field_bits = sum_bits(false);
+
+    /// bits of the key coming from the seed
+    static constexpr unsigned seed_bits =
+        impl::array_bits<key_type>() - key_field_bits;
+
+    /// counter bits below the domain field, for the counter fields
+    /// and the blocks
+    static constexpr unsigned stream_counter_bits =
+        impl::array_bits<ctr_type>() -
+        unsigned(impl::counter_domain_bits<ctr_type>());
+
+    /// each stream holds 2^block_bits blocks
+    static constexpr unsigned block_bits =
+        stream_counter_bits - counter_field_bits;
+
+    /// a stream of 2^64 blocks can not be exhausted: beyond them the block
+    /// index would carry into the counter fields, the stream of other ids
+    static constexpr unsigned min_block_bits = 64;
+
+    static_assert(valid_fields(), "fields of 1 to 64 bits, tag values must "
+                                  "fit their field");
+    static_assert(key_field_bits <= impl::array_bits<key_type>(),
+                  "the key fields do not fit in the key");
+    static_assert(counter_field_bits <= stream_counter_bits &&
+                      block_bits >= min_block_bits,
+                  "the counter fields leave less than 2^64 blocks to the "
+                  "streams");
+
+    /// key of the stream ids, the seed gives the bits out of the fields
+    template <typename... Ids>
+    static key_type key(const key_type &seed, Ids... ids) {
+        key_type res(seed);
+        ctr_type unused{};
+        pack(res, unused, ids...);
+        return res;
+    }
+
+    /// first counter of the stream ids, the block bits are zero
+    template <typename... Ids> static ctr_type counter(Ids... ids) {
+        key_type unused{};
+        ctr_type res{};
+        pack(unused, res, ids...);
+        return res;
+    }
+
+    /// engine at the start of the stream ids: the key schedule and no
+    /// block computed
+    template <typename... Ids>
+    static engine_type engine(const key_type &seed, Ids... ids) {
+        key_type k(seed);
+        ctr_type c{};
+        pack(k, c, ids...);
+        return engine_type(k, c);
+    }
+
+    /// bits of the fields and of the tags of this layout
+    static constexpr impl::stream_fixed_bits<key_type> key_bits() {
+        impl::stream_fixed_bits<key_type> res{};
+        unsigned top = impl::array_bits<key_type>();
+        for (const impl::stream_field_info &field : fields) {
+            if (field.in_key) {
+                top -= field.bits;
+                mark(res, top, field);
+            }
+        }
+        return res;
+    }
+
+    static constexpr impl::stream_fixed_bits<ctr_type> counter_bits() {
+        impl::stream_fixed_bits<ctr_type> res{};
+        unsigned top = stream_counter_bits;
+        for (const impl::stream_field_info &field : fields) {
+            if (!field.in_key) {
+                top -= field.bits;
+                mark(res, top, field);
+            }
+        }
+        return res;
+    }
+
+  private:
+    template <typename Array>
+    static constexpr void mark(impl::stream_fixed_bits<Array> &res,
+                               unsigned position,
+                               const impl::stream_field_info &field) {
+        impl::array_set_bits(res.fields, position, field.bits,
+                             ~std::uint64_t(0));
+        if (field.is_tag) {
+            impl::array_set_bits(res.tag_mask, position, field.bits,
+                                 ~std::uint64_t(0));
+            impl::array_set_bits(res.tag_value, position, field.bits,
+                                 field.value);
+        }
+    }
+
+    /// bit position of the field index, in the key or in the counter
+    static constexpr unsigned position(std::size_t index) {
+        const bool in_key = fields[index].in_key;
+        unsigned res =
+            in_key ? impl::array_bits<key_type>() : stream_counter_bits;
+        for (std::size_t i = 0; i <= index; ++i) {
+            res -= fields[i].in_key == in_key ? fields[i].bits : 0;
+        }
+        return res;
+    }
+
+    /// rank of the field index among the ids
+    static constexpr std::size_t id_rank(std::size_t index) {
+        std::size_t res = 0;
+        for (std::size_t i = 0; i < index; ++i) {
+            res += fields[i].is_tag ? 0 : 1;
+        }
+        return res;
+    }
+
+    template <typename... Ids>
+    static void pack(key_type &k, ctr_type &c, Ids... ids) {
+        static_assert(sizeof...(Ids) == n_ids,
+                      "one id per field of the layout");
+        const std::array<std::uint64_t, n_ids> values = {
+            {static_cast<std::uint64_t>(ids)...}};
+        pack(k, c, values, std::make_index_sequence<n_fields>());
+    }
+
+    template <std::size_t... Index>
+    static void pack(key_type &k, ctr_type &c,
+                     const std::array<std::uint64_t, n_ids> &values,
+                     std::index_sequence<Index...>) {
+        (pack_field<Index>(k, c, values), ...);
+    }
+
+    /// the positions are constants, packing is a few shifts and masks
+    template <std::size_t Index>
+    static void pack_field(key_type &k, ctr_type &c,
+                           const std::array<std::uint64_t, n_ids> &values) {
+        constexpr impl::stream_field_info field = fields[Index];
+
+        std::uint64_t value = field.value;
+        if constexpr (!field.is_tag) {
+            value = values[id_rank(Index)];
+            if (field.bits < 64 && (value >> (field.bits % 64)) != 0) {
+                throw std::out_of_range("alea::stream_layout: id wider "
+                                        "than its field");
+            }
+        }
+
+        if constexpr (field.in_key) {
+            impl::array_set_bits(k, position(Index), field.bits, value);
+        } else {
+            impl::array_set_bits(c, position(Index), field.bits, value);
+        }
+    }
+};
+
+namespace impl {
+
+template <typename Array>
+constexpr bool tags_differ(const stream_fixed_bits<Array> &a,
+                           const stream_fixed_bits<Array> &b) {
+    for (std::size_t i = 0; i < std::tuple_size<Array>::value; ++i) {
+        if ((a.tag_mask[i] & b.tag_mask[i] &
+             (a.tag_value[i] ^ b.tag_value[i])) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace impl
+
+///
+/// true if no stream of LayoutA can share a block with a stream of
+/// LayoutB, whatever the ids and the seeds
+///
+/// A block of a stream is fixed by the key and the counter: the streams
+/// of two layouts are disjoint when both fix a bit of the key, or of the
+/// counter, to different tag values. Without such a bit some ids and
+/// seeds make them meet, the check is exact for the tags. Both layouts
+/// must be layouts of the same generator.
+///
+template <typename LayoutA, typename LayoutB>
+constexpr bool streams_disjoint() {
+    static_assert(
+        std::is_same<typename LayoutA::cbrng_type,
+                     typename LayoutB::cbrng_type>::value,
+        "streams_disjoint requires layouts of the same generator");
+
+    return impl::tags_differ(LayoutA::key_bits(), LayoutB::key_bits()) ||
+           impl::tags_differ(LayoutA::counter_bits(),
+                             LayoutB::counter_bits());
+}
+
+} // namespace alea
+
+#endif // _ALEA_STREAM_LAYOUT_HPP_
@@ -0,0 +1,196 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_THREAD_POOL_HPP_
+#define _ALEA_THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+///
+/// thread_pool is a small fork-join pool: parallel_for(n, f) calls f(i)
+/// for every i in [0, n) on the workers and on the calling thread, and
+/// returns when all the calls are done
+///
+///    alea::thread_pool pool(4);
+///    pool.parallel_for(100, [&](std::size_t i) { work(i); });
+///
+/// One parallel_for runs at a time; the indices are handed out in order
+/// from an atomic counter, so uneven tasks balance on their own.
+///
+
+namespace alea {
+
+class thread_pool {
+  public:
+    /// a pool running parallel_for on concurrency threads, the calling
+    /// thread included
+    explicit thread_pool(std::size_t concurrency = default_concurrency())
+        : _job(nullptr), _generation(0), _stop(false) {
+        const std::size_t nworkers = std::max<std::size_t>(concurrency, 1) - 1;
+        _workers.reserve(nworkers);
+        for (std::size_t i = 0; i < nworkers; ++i) {
+            _workers.emplace_back([this] { work(); });
+        }
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (std::thread &worker : _workers) {
+            worker.join();
+        }
+    }
+
+    /// number of threads running a parallel_for, the caller included
+    std::size_t concurrency() const { return _workers.size() + 1; }
+
+    static std::size_t default_concurrency() {
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    /// call f(i) for i in [0, n), the first exception thrown by f is
+    /// rethrown here once the running calls are done
+    template <typename Function>
+    void parallel_for(std::size_t n, Function &&f) {
+        if (n == 0) {
+            return;
+        }
+
+        job current(n, &f, [](void *fun, std::size_t i) {
+            (*static_cast<std::remove_reference_t<Function> *>(fun))(i);
+        });
+
+        if (!_workers.empty() && n > 1) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _job = &current;
+                ++_generation;
+            }
+            _wake.notify_all();
+        }
+
+        current.run();
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _done.wait(lock, [&] { return current.workers == 0; });
+            _job = nullptr;
+        }
+
+        if (current.error) {
+            std::rethrow_exception(current.error);
+        }
+    }
+
+  private:
+    struct job {
+        job(std::size_t n, void *f, void (*call)(void *, std::size_t))
+            : count(n), next(0), function(f), invoke(call), workers(0),
+              error() {}
+
+        void run() {
+            for (std::size_t i = next.fetch_add(1); i < count;
+                 i = next.fetch_add(1)) {
+                try {
+                    invoke(function, i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    next.store(count);
+                }
+            }
+        }
+
+        const std::size_t count;
+        std::atomic<std::size_t> next;
+        void *const function;
+        void (*const invoke)(void *, std::size_t);
+        std::size_t workers; // guarded by the pool mutex
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    void work() {
+        std::size_t seen = 0;
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;) {
+            _wake.wait(lock, [&] {
+                return _stop || (_job != nullptr && _generation != seen);
+            });
+            if (_stop) {
+                return;
+            }
+            seen = _generation;
+            job *current = _job;
+            ++current->workers;
+
+            lock.unlock();
+            current->run();
+            lock.lock();
+
+            if (--current->workers == 0) {
+                _done.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _wake, _done;
+    job *_job;
+    std::size_t _generation;
+    bool _stop;
+};
+
+/// process wide pool of thread_pool::default_concurrency() threads,
+/// created on first use
+inline thread_pool &default_thread_pool() {
+    static thread_pool pool;
+    return pool;
+}
+
+} // namespace alea
+
+#endif // _ALEA_THREAD_POOL_HPP_
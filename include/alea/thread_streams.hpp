@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_THREAD_STREAMS_HPP_
+#define _ALEA_THREAD_STREAMS_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "impl/cache_line.hpp"
+#include "random_derivate.hpp"
+
+///
+/// thread_streams<Engine> holds one engine per worker, derived from a
+/// root engine with random_engine_derivate(root, worker): the engine of
+/// a worker only depends on the root and on the worker index
+///
+/// Every engine sits in its own cache line padded slot, so workers
+/// drawing from neighbouring engines do not share cache lines.
+///
+///    alea::thread_streams<alea::counter_engine<alea::threefry4x64>>
+///        streams(root, n_workers);
+///
+///    // in the worker w
+///    alea::set_worker_index(w);
+///    auto &engine = streams.local();
+///    double x = dist(engine);
+///
+/// local() reads the worker index of the calling thread from a trivial
+/// thread_local: no TLS guard nor destructor on the hot path. Each thread
+/// sets its index first with set_worker_index, local() throws
+/// std::logic_error on a thread without index: the engine of a worker is
+/// then a function of its index only, never of the thread start order.
+/// A new thread may take the index of a finished one. Inner loops keep
+/// the reference: the engine writes may alias the thread_local, which is
+/// then read again at each call.
+///
+
+namespace alea {
+
+namespace impl {
+
+constexpr std::size_t no_worker_index = std::numeric_limits<std::size_t>::max();
+
+inline thread_local std::size_t worker_index_value = no_worker_index;
+
+} // namespace impl
+
+/// give the index worker to the calling thread
+inline void set_worker_index(std::size_t worker) {
+    impl::worker_index_value = worker;
+}
+
+/// worker index of the calling thread, throws std::logic_error if the
+/// thread has none
+inline std::size_t worker_index() {
+    if (impl::worker_index_value == impl::no_worker_index) {
+        throw std::logic_error("alea::thread_streams: set_worker_index must "
+                               "be called by the thread before local()");
+    }
+    return impl::worker_index_value;
+}
+
+template <typename Engine> class thread_streams {
+  public:
+    typedef Engine engine_type;
+    typedef typename Engine::result_type result_type;
+
+    /// n_workers engines derived from root
+    explicit thread_streams(const Engine &root,
+                            std::size_t n_workers = default_workers())
+        : _slots() {
+        _slots.reserve(n_workers);
+        for (std::size_t i = 0; i < n_workers; ++i) {
+            _slots.push_back(
+                slot{random_engine_derivate(root, result_type(i))});
+        }
+    }
+
+    std::size_t size() const { return _slots.size(); }
+
+    static std::size_t default_workers() {
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    /// engine of the worker worker
+    Engine &operator[](std::size_t worker) { return _slots[worker].engine; }
+
+    const Engine &operator[](std::size_t worker) const {
+        return _slots[worker].engine;
+    }
+
+    /// engine of the worker worker, checks the index
+    Engine &at(std::size_t worker) {
+        if (worker >= _slots.size()) {
+            throw std::out_of_range("alea::thread_streams: no engine for "
+                                    "this worker index");
+        }
+        return _slots[worker].engine;
+    }
+
+    /// engine of the calling thread, see worker_index
+    Engine &local() { return at(worker_index()); }
+
+  private:
+    struct alignas(impl::cache_line_size) slot {
+        Engine engine;
+    };
+
+    std::vector<slot> _slots;
+};
+
+} // namespace alea
+
+#endif // _ALEA_THREAD_STREAMS_HPP_
@@ -39,9 +39,11 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
-#include <numeric>
+#include <limits>
 #include <random>
 
+#include "impl/simd_dispatch.hpp"
+
 ///
 ///  threefry is a state-less counter base random generator
 ///  derivated from the block cipher threefish
@@ -94,7 +96,7 @@ template <unsigned _N, typename Uint> struct threefry_constants {};
 
 // 2x32 constants
 template <> struct threefry_constants<2, uint32_t> {
-    static inline unsigned rotations(int pos) {
+    static constexpr unsigned rotations(int pos) {
         constexpr unsigned rotations[8] = {13, 15, 26, 6, 17, 29, 16, 24};
         return rotations[pos % 8];
     }
@@ -102,12 +104,12 @@ template <> struct threefry_constants<2, uint32_t> {
 
 // 4x32 contants
 template <> struct threefry_constants<4, uint32_t> {
-    static inline unsigned rotations0(int pos) {
+    static constexpr unsigned rotations0(int pos) {
         constexpr unsigned rotations[8] = {10, 11, 13, 23, 6, 17, 25, 18};
         return rotations[pos % 8];
     }
 
-    static inline unsigned rotations1(int pos) {
+    static constexpr unsigned rotations1(int pos) {
         constexpr unsigned rotations[8] = {26, 21, 27, 5, 20, 11, 10, 20};
         return rotations[pos % 8];
     }
@@ -115,7 +117,7 @@ template <> struct threefry_constants<4, uint32_t> {
 
 // 2x64 constants
 template <> struct threefry_constants<2, uint64_t> {
-    static inline unsigned rotations(int pos) {
+    static constexpr unsigned rotations(int pos) {
         constexpr unsigned rotations[8] = {16, 42, 12, 31, 16, 32, 24, 21};
         return rotations[pos % 8];
     }
@@ -123,19 +125,24 @@ template <> struct threefry_constants<2, uint64_t> {
 
 // 4x64 constants
 template <> struct threefry_constants<4, uint64_t> {
-    static inline unsigned rotations0(int pos) {
+    static constexpr unsigned rotations0(int pos) {
         constexpr unsigned rotations[8] = {14, 52, 23, 5, 25, 46, 58, 32};
         return rotations[pos % 8];
     }
 
-    static inline unsigned rotations1(int pos) {
+    static constexpr unsigned rotations1(int pos) {
         constexpr unsigned rotations[8] = {16, 57, 40, 37, 33, 12, 22, 32};
         return rotations[pos % 8];
     }
 };
 
-template <typename Uint> inline Uint threefry_rotl(Uint x, unsigned s) {
-    return (x << s) | (x >> (std::numeric_limits<Uint>::digits - s));
+/// rotate left in place each Uint word of x
+///
+/// Word is either Uint itself or a SIMD lane vector of Uint
+/// (see impl/threefry_simd_impl.hpp)
+template <typename Uint, typename Word>
+constexpr void threefry_rotl(Word &x, unsigned s) {
+    x = (x << s) | (x >> (std::numeric_limits<Uint>::digits - s));
 }
 
 /// the number of rounds is known at compile time
@@ -147,6 +154,9 @@ template <typename Uint> inline Uint threefry_rotl(Uint x, unsigned s) {
 ///
 /// Performance gain evaluated to x4 on Intel I7 compared to a loop version
 ///
+/// The key schedule words are either Uint, or lane vectors when each lane
+/// uses its own key (see keyed_batch)
+///
 
 template <std::uint64_t r_remain, std::uint64_t r_max, typename Uint,
           typename Domain, typename Constants, std::uint64_t N>
@@ -160,15 +170,17 @@ struct rounds_functor<r_remain, r_max, Uint, Domain, Constants, 4> {
     typedef Uint uint_type;
     typedef Domain domain_type;
 
-    inline void operator()(const utils::array<uint_type, 5> &ks,
-                           domain_type &c) {
+    template <typename KeySchedule>
+    constexpr void operator()(const KeySchedule &ks, domain_type &c) {
         constexpr std::uint64_t r = r_max - r_remain;
 
         if constexpr ((r & 0x01)) {
             c[0] += c[3];
             c[2] += c[1];
-            c[3] = threefry_rotl(c[3], Constants::rotations0(r)) ^ c[0];
-            c[1] = threefry_rotl(c[1], Constants::rotations1(r)) ^ c[2];
+            threefry_rotl<Uint>(c[3], Constants::rotations0(r));
+            threefry_rotl<Uint>(c[1], Constants::rotations1(r));
+            c[3] ^= c[0];
+            c[1] ^= c[2];
 
             constexpr std::uint64_t r_next = r + 1;
             constexpr std::uint64_t r4 = r_next >> 2;
@@ -178,18 +190,21 @@ struct rounds_functor<r_remain, r_max, Uint, Domain, Constants, 4> {
                 c[0] += ks[(r4 + 0) % 5];
                 c[1] += ks[(r4 + 1) % 5];
                 c[2] += ks[(r4 + 2) % 5];
-                c[3] += ks[(r4 + 3) % 5] + r4;
+                c[3] += ks[(r4 + 3) % 5];
+                c[3] += uint_type(r4);
             }
 
         } else {
             c[0] += c[1];
             c[2] += c[3];
-            c[1] = threefry_rotl(c[1], Constants::rotations0(r)) ^ c[0];
-            c[3] = threefry_rotl(c[3], Constants::rotations1(r)) ^ c[2];
+            threefry_rotl<Uint>(c[1], Constants::rotations0(r));
+            threefry_rotl<Uint>(c[3], Constants::rotations1(r));
+            c[1] ^= c[0];
+            c[3] ^= c[2];
         }
         rounds_functor<r_remain - 1, r_max, uint_type, domain_type, Constants,
                        4>
-            func;
+            func{};
         func(ks, c);
         return;
     }
@@ -201,8 +216,8 @@ struct rounds_functor<0, r_max, Uint, Domain, Constants, 4> {
     typedef Uint uint_type;
     typedef Domain domain_type;
 
-    inline void operator()(const utils::array<uint_type, 5> &ks,
-                           domain_type &c) {
+    template <typename KeySchedule>
+    constexpr void operator()(const KeySchedule &ks, domain_type &c) {
         (void)ks;
         (void)c;
     }
@@ -214,12 +229,12 @@ struct rounds_functor<r_remain, r_max, Uint, Domain, Constants, 2> {
     typedef Uint uint_type;
     typedef Domain domain_type;
 
-    inline void operator()(const utils::array<uint_type, 3> &ks,
-                           domain_type &c) {
+    template <typename KeySchedule>
+    constexpr void operator()(const KeySchedule &ks, domain_type &c) {
         constexpr std::uint64_t r = r_max - r_remain;
 
         c[0] += c[1];
-        c[1] = threefry_rotl(c[1], Constants::rotations(r));
+        threefry_rotl<Uint>(c[1], Constants::rotations(r));
         c[1] ^= c[0];
 
         constexpr std::uint64_t r_next = r + 1;
@@ -228,12 +243,13 @@ struct rounds_functor<r_remain, r_max, Uint, Domain, Constants, 2> {
 
         if constexpr (r_next_mod_4 == 0) {
             c[0] += ks[r4 % 3];
-            c[1] += ks[(r4 + 1) % 3] + r4;
+            c[1] += ks[(r4 + 1) % 3];
+            c[1] += uint_type(r4);
         }
 
         rounds_functor<r_remain - 1, r_max, uint_type, domain_type, Constants,
                        2>
-            func;
+            func{};
         func(ks, c);
         return;
     }
@@ -245,8 +261,8 @@ struct rounds_functor<0, r_max, Uint, Domain, Constants, 2> {
     typedef Uint uint_type;
     typedef Domain domain_type;
 
-    inline void operator()(const utils::array<uint_type, 3> &ks,
-                           domain_type &c) {
+    template <typename KeySchedule>
+    constexpr void operator()(const KeySchedule &ks, domain_type &c) {
         (void)ks;
         (void)c;
     }
@@ -265,8 +281,8 @@ class threefry {
     typedef utils::array<Uint, N> key_type;
     typedef Uint uint_type;
 
-    explicit threefry() : k() {}
-    explicit threefry(key_type _k) : k(_k) {}
+    constexpr explicit threefry() : k() {}
+    constexpr explicit threefry(key_type _k) : k(_k) {}
 
     threefry(const threefry &) = default;
     threefry(threefry &&) = default;
@@ -274,31 +290,58 @@ class threefry {
     threefry &operator=(const threefry &) = default;
     threefry &operator=(threefry &&) = default;
 
-    void set_key(key_type _k) { k = _k; }
+    constexpr void set_key(key_type _k) { k = _k; }
 
-    key_type get_key() const { return k; }
+    constexpr key_type get_key() const { return k; }
 
     bool operator==(const threefry &rhs) const { return k == rhs.k; }
     bool operator!=(const threefry &rhs) const { return k != rhs.k; }
 
-    inline range_type operator()(const domain_type &counter) {
+    /// usable in constant expressions, e.g. to build random tables at
+    /// compile time that match the runtime stream
+    constexpr range_type operator()(const domain_type &counter) const {
         using namespace impl;
-        utils::array<uint_type, N + 1> ks;
+        const utils::array<uint_type, N + 1> ks = key_schedule();
         domain_type c(counter);
 
-        utils::copy(k.begin(), k.end(), ks.begin());
-        ks[N] = utils::accumulate(k.begin(), k.end(), uint_ks_parity<Uint>(),
-                                  utils::bit_xor<uint_type>());
-        utils::transform(k.begin(), k.end(), c.begin(), c.begin(),
-                         utils::plus<uint_type>());
+        for (unsigned w = 0; w < N; ++w) {
+            c[w] += k[w];
+        }
 
-        rounds_functor<R, R, uint_type, domain_type, Constants, N> func;
+        rounds_functor<R, R, uint_type, domain_type, Constants, N> func{};
         func(ks, c);
 
         return c;
     }
 
+    /// encrypt the nblocks consecutive counters
+    /// counter, counter + 1, ..., counter + nblocks - 1
+    /// and store the resulting blocks contiguously in out
+    ///
+    /// The work is dispatched at runtime to the widest SIMD kernel
+    /// supported by the CPU, all kernels give bit-identical results
+    inline void operator()(const domain_type &counter, uint_type *out,
+                           std::size_t nblocks) const {
+        encrypt_blocks(impl::simd_isa_best(), counter, out, nblocks);
+    }
+
+    /// same as above with an explicit kernel selection
+    inline void encrypt_blocks(impl::simd_isa isa, const domain_type &counter,
+                               uint_type *out, std::size_t nblocks) const;
+
   private:
+    constexpr utils::array<uint_type, N + 1> key_schedule() const {
+        using namespace impl;
+        utils::array<uint_type, N + 1> ks{};
+
+        ks[N] = uint_ks_parity<Uint>();
+        for (unsigned w = 0; w < N; ++w) {
+            ks[w] = k[w];
+            ks[N] ^= k[w];
+        }
+        return ks;
+    }
+
     key_type k;
 };
 
@@ -314,4 +357,6 @@ typedef threefry<4, std::uint64_t> threefry_default;
 
 } // namespace alea
 
+#include "impl/threefry_simd_impl.hpp"
+
 #endif // _ALEA_RANDOM_THREEFRY_
@@ -0,0 +1,228 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+#ifndef _ALEA_VARIANT_ENGINE_MAPPER_HPP_
+#define _ALEA_VARIANT_ENGINE_MAPPER_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "impl/engine_fill.hpp"
+#include "jump.hpp"
+#include "random.hpp"
+#include "random_derivate.hpp"
+#include "random_engine_mapper.hpp"
+
+namespace alea {
+
+///
+/// closed set of engines available to variant_engine_mapper<Uint>:
+/// the alea engines and the standard engines producing full range
+/// Uint values
+///
+template <typename Uint> struct variant_engines {};
+
+template <> struct variant_engines<std::uint32_t> {
+    typedef std::variant<counter_engine<threefry4x32>,
+                         counter_engine<threefry2x32>,
+                         counter_engine<philox4x32>, counter_engine<chacha8>,
+                         counter_engine<chacha20>, counter_engine<ars4x32>,
+                         counter_engine<squares32>, std::mt19937>
+        type;
+};
+
+template <> struct variant_engines<std::uint64_t> {
+    typedef std::variant<counter_engine<threefry4x64>,
+                         counter_engine<threefry2x64>,
+                         counter_engine<philox4x64>,
+                         counter_engine<philox2x64>,
+                         counter_engine<squares64>,
+                         counter_engine<splitmix64>, xoshiro256ss,
+#ifdef __SIZEOF_INT128__
+                         pcg64_dxsm,
+#endif
+                         std::mt19937_64>
+        type;
+};
+
+///
+/// runtime selection of a random engine without virtual calls
+///
+/// Same use than random_engine_mapper, but the engine is stored in place
+/// in a std::variant of the known engines ( variant_engines<Uint> )
+/// instead of behind a heap allocated virtual interface. Each value
+/// costs a jump on the engine index which the compiler can inline,
+/// and fill / generate_n dispatch once per batch and then run the
+/// engine loop ( or its bulk SIMD fill ) directly
+///
+/// Contrary to random_engine_mapper, variant_engine_mapper is copyable
+///
+template <typename Uint> class variant_engine_mapper {
+  public:
+    typedef Uint result_type;
+    typedef typename variant_engines<Uint>::type variant_type;
+
+    /// default constructor, maps the default counter_engine
+    explicit variant_engine_mapper() : _engine() {}
+
+    /// map any engine of variant_engines<Uint>
+    template <typename Engine,
+              typename = typename std::enable_if<!std::is_same<
+                  typename std::decay<Engine>::type,
+                  variant_engine_mapper>::value>::type>
+    explicit variant_engine_mapper(Engine &&intern)
+        : _engine(std::forward<Engine>(intern)) {}
+
+    variant_engine_mapper(const variant_engine_mapper &) = default;
+    variant_engine_mapper(variant_engine_mapper &&) = default;
+
+    variant_engine_mapper &operator=(const variant_engine_mapper &) = default;
+    variant_engine_mapper &operator=(variant_engine_mapper &&) = default;
+
+    /// reset to default seed, mapping
+    void seed() {
+        std::visit([](auto &e) { e.seed(); }, _engine);
+    }
+
+    /// reset to seed X, mapping
+    void seed(result_type s) {
+        std::visit([s](auto &e) { e.seed(s); }, _engine);
+    }
+
+    /// generator operation
+    result_type operator()() {
+        return std::visit([](auto &e) { return result_type(e()); }, _engine);
+    }
+
+    /// fill [first, last) with the next values of the engine,
+    /// with a single dispatch
+    template <typename ForwardIterator>
+    void fill(ForwardIterator first, ForwardIterator last) {
+        std::visit(
+            [first, last](auto &e) {
+                typedef typename std::decay<decltype(e)>::type engine_type;
+                if constexpr (impl::has_engine_fill<engine_type,
+                                                    ForwardIterator>::value) {
+                    e.fill(first, last);
+                } else {
+                    std::generate(first, last, std::ref(e));
+                }
+            },
+            _engine);
+    }
+
+    /// write the n next values of the engine to first,
+    /// with a single dispatch
+    template <typename OutputIterator>
+    OutputIterator generate_n(OutputIterator first, std::size_t n) {
+        return std::visit(
+            [first, n](auto &e) {
+                typedef typename std::decay<decltype(e)>::type engine_type;
+                if constexpr (impl::has_generate_n<engine_type,
+                                                   OutputIterator>::value) {
+                    return e.generate_n(first, n);
+                } else {
+                    return std::generate_n(
+                        first, n, [&e]() { return result_type(e()); });
+                }
+            },
+            _engine);
+    }
+
+    /// skip the n next values, see alea::jump
+    void discard(impl::counter_wide_uint n) {
+        std::visit([n](auto &e) { jump(e, n); }, _engine);
+    }
+
+    /// derivate a new engine of the same type, see
+    /// random_engine_mapper::derivate
+    variant_engine_mapper derivate(result_type key) const {
+        return std::visit(
+            [key](const auto &e) {
+                return variant_engine_mapper(random_engine_derivate(e, key));
+            },
+            _engine);
+    }
+
+    /// position of the mapped engine in variant_engines<Uint>
+    std::size_t index() const { return _engine.index(); }
+
+    /// pointer to the mapped engine if it is an Engine, nullptr otherwise
+    template <typename Engine> Engine *get_if() {
+        return std::get_if<Engine>(&_engine);
+    }
+
+    template <typename Engine> const Engine *get_if() const {
+        return std::get_if<Engine>(&_engine);
+    }
+
+    static constexpr result_type min() {
+        return std::numeric_limits<result_type>::min();
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    friend bool operator==(const variant_engine_mapper &lhs,
+                           const variant_engine_mapper &rhs) {
+        return lhs._engine == rhs._engine;
+    }
+
+    friend bool operator!=(const variant_engine_mapper &lhs,
+                           const variant_engine_mapper &rhs) {
+        return !(lhs == rhs);
+    }
+
+  private:
+    variant_type _engine;
+};
+
+typedef variant_engine_mapper<std::uint32_t> variant_engine_mapper_32;
+typedef variant_engine_mapper<std::uint64_t> variant_engine_mapper_64;
+
+// specialize random_engine_derivate
+// for variant mapper
+template <typename Uint>
+inline variant_engine_mapper<Uint> random_engine_derivate(
+    const variant_engine_mapper<Uint> &engine,
+    const typename variant_engine_mapper<Uint>::result_type &key) {
+    return engine.derivate(key);
+}
+
+} // namespace alea
+
+#endif // _ALEA_VARIANT_ENGINE_MAPPER_HPP_
@@ -0,0 +1,286 @@
+/**
+ * Copyright (c) 2021, Adrien Devresse <adev@adev.name>
+ *
+ * Boost Software License - Version 1.0
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef _ALEA_RANDOM_XOSHIRO_
+#define _ALEA_RANDOM_XOSHIRO_
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "impl/block_counter.hpp"
+#include "impl/gf2_polynomial.hpp"
+#include "splitmix.hpp"
+#include "threefry.hpp"
+
+///
+///  xoshiro256** is the 64 bits all-purpose stateful generator of
+///  D. Blackman and S. Vigna
+///  "Scrambled linear pseudorandom number generators" (arXiv:1805.01407)
+///
+///  256 bits of state, period 2^256 - 1, passes BigCrush and PractRand,
+///  and a single step is a handful of shifts, rotations and xors: it is
+///  the fastest generator of alea after the counter hashes
+///
+///  The state is linear over GF(2), which allows to jump ahead:
+///   - jump() advances by 2^128 steps, long_jump() by 2^192 steps
+///   - advance(n) / discard(n) advance by n steps in O(log n), the
+///     skips below step_limit by stepping
+///
+///  derivate(key) seeds a child engine from a threefry encryption
+///  of the parent state: children of different keys are independent
+///  of each other and of their parent
+///
+
+namespace alea {
+
+class xoshiro256ss {
+  public:
+    typedef std::uint64_t result_type;
+    typedef std::array<std::uint64_t, 4> state_type;
+
+    static constexpr result_type default_seed = 0;
+
+    explicit xoshiro256ss() { seed(); }
+
+    explicit xoshiro256ss(result_type r) { seed(r); }
+
+    explicit xoshiro256ss(std::seed_seq &seq) { seed(seq); }
+
+    explicit xoshiro256ss(const state_type &state) : s(state) {}
+
+    xoshiro256ss(const xoshiro256ss &) = default;
+    xoshiro256ss(xoshiro256ss &&) = default;
+
+    xoshiro256ss &operator=(const xoshiro256ss &) = default;
+    xoshiro256ss &operator=(xoshiro256ss &&) = default;
+
+    void seed() { seed(default_seed); }
+
+    /// the state is initialized from the splitmix64 sequence of r
+    /// as recommended by the authors
+    void seed(result_type r) {
+        for (std::uint64_t &w : s) {
+            r += impl::splitmix64_gamma;
+            w = impl::splitmix64_mix(r);
+        }
+    }
+
+    template <typename SeedSeq> void seed(SeedSeq &seq) {
+        std::array<std::uint32_t, 8> words;
+        seq.generate(words.begin(), words.end());
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            s[i] = std::uint64_t(words[2 * i]) |
+                   std::uint64_t(words[2 * i + 1]) << 32;
+        }
+        fix_zero_state();
+    }
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    inline result_type operator()() {
+        const result_type res = rotl(s[1] * 5, 7) * 9;
+        step();
+        return res;
+    }
+
+    /// skips up to step_limit values are stepped: the polynomial jump
+    /// costs about as much as 10^5 steps
+    static constexpr std::uint64_t step_limit = std::uint64_t(1) << 16;
+
+    /// skip n values in O(log n), n can be any integer type including
+    /// __uint128_t, a negative n throws std::invalid_argument
+    template <typename Integer>
+    typename std::enable_if<impl::is_jump_integer<Integer>::value>::type
+    discard(Integer n) {
+        typedef typename impl::is_jump_integer<Integer>::unsigned_type UInt;
+        impl::check_skip(n);
+        const UInt steps = static_cast<UInt>(n);
+
+        if constexpr (impl::counter_digits<UInt>() > 64) {
+            if (steps <= step_limit) {
+                advance(std::uint64_t(steps));
+                return;
+            }
+            const std::array<std::uint64_t, 2> exponent = {
+                {std::uint64_t(steps), std::uint64_t(steps >> 64)}};
+            apply_polynomial(impl::gf2_powmod_x<256>(
+                exponent, characteristic_polynomial()));
+        } else {
+            advance(std::uint64_t(steps));
+        }
+    }
+
+    /// advance the state by n steps in O(log n)
+    void advance(std::uint64_t n) {
+        if (n <= step_limit) {
+            for (; n > 0; --n) {
+                step();
+            }
+            return;
+        }
+        const std::array<std::uint64_t, 1> exponent = {{n}};
+        apply_polynomial(
+            impl::gf2_powmod_x<256>(exponent, characteristic_polynomial()));
+    }
+
+    /// advance the state by 2^128 steps
+    ///
+    /// it can be used to generate 2^128 non-overlapping subsequences
+    /// of 2^128 values for parallel computations
+    void jump() {
+        static const state_type jump_polynomial = {
+            {UINT64_C(0x180ec6d33cfd0aba), UINT64_C(0xd5a61266f0c9392c),
+             UINT64_C(0xa9582618e03fc9aa), UINT64_C(0x39abdc4529b1661c)}};
+        apply_polynomial(jump_polynomial);
+    }
+
+    /// advance the state by 2^192 steps
+    ///
+    /// it can be used to generate 2^64 starting points, from each of which
+    /// jump() generates 2^64 non-overlapping subsequences
+    void long_jump() {
+        static const state_type long_jump_polynomial = {
+            {UINT64_C(0x76e15d3efefdcbbf), UINT64_C(0xc5004e441c522fb3),
+             UINT64_C(0x77710069854ee241), UINT64_C(0x39109bb02acbe635)}};
+        apply_polynomial(long_jump_polynomial);
+    }
+
+    /// create an engine independent of this one for the given key
+    xoshiro256ss derivate(result_type key) const {
+        const threefry4x64 cipher(s);
+        const threefry4x64::range_type block =
+            cipher({{key, UINT64_C(0x786f736869726f), 0, 0}});
+
+        xoshiro256ss res(state_type{{block[0], block[1], block[2], block[3]}});
+        res.fix_zero_state();
+        return res;
+    }
+
+    state_type state() const { return s; }
+
+    /// characteristic polynomial of the xoshiro256 linear transition
+    /// without its leading term x^256, computed once
+    static const impl::gf2_polynomial<256> &characteristic_polynomial() {
+        static const impl::gf2_polynomial<256> polynomial = []() {
+            // any non zero linear projection of the state generates a
+            // sequence with the full characteristic polynomial
+            xoshiro256ss engine(state_type{{1, 0, 0, 0}});
+            std::vector<std::uint8_t> sequence(2 * 256);
+            for (std::uint8_t &bit : sequence) {
+                bit = std::uint8_t(engine.s[0] & 1);
+                engine.step();
+            }
+            return impl::gf2_berlekamp_massey<256>(sequence);
+        }();
+        return polynomial;
+    }
+
+    friend bool operator==(const xoshiro256ss &lhs, const xoshiro256ss &rhs) {
+        return lhs.s == rhs.s;
+    }
+
+    friend bool operator!=(const xoshiro256ss &lhs, const xoshiro256ss &rhs) {
+        return lhs.s != rhs.s;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os,
+                                    const xoshiro256ss &engine) {
+        return os << engine.s[0] << " " << engine.s[1] << " " << engine.s[2]
+                  << " " << engine.s[3];
+    }
+
+    friend std::istream &operator>>(std::istream &is, xoshiro256ss &engine) {
+        return is >> engine.s[0] >> engine.s[1] >> engine.s[2] >>
+               engine.s[3];
+    }
+
+  private:
+    static inline std::uint64_t rotl(std::uint64_t x, unsigned k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    inline void step() {
+        const std::uint64_t t = s[1] << 17;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+
+        s[2] ^= t;
+
+        s[3] = rotl(s[3], 45);
+    }
+
+    /// replace the state by sum_i coef_i(polynomial) * state_i
+    template <typename Polynomial>
+    void apply_polynomial(const Polynomial &polynomial) {
+        state_type res = {{0, 0, 0, 0}};
+        for (std::size_t i = 0; i < 256; ++i) {
+            if ((polynomial[i / 64] >> (i % 64)) & 1) {
+                for (std::size_t w = 0; w < s.size(); ++w) {
+                    res[w] ^= s[w];
+                }
+            }
+            step();
+        }
+        s = res;
+    }
+
+    /// the all zero state is a fixed point of the generator
+    void fix_zero_state() {
+        if (s == state_type{{0, 0, 0, 0}}) {
+            seed();
+        }
+    }
+
+    state_type s;
+};
+
+// specialize random_engine_derivate
+// for xoshiro256**
+inline xoshiro256ss
+random_engine_derivate(const xoshiro256ss &engine,
+                       const xoshiro256ss::result_type &key) {
+    return engine.derivate(key);
+}
+
+} // namespace alea
+
+#endif // _ALEA_RANDOM_XOSHIRO_
@@ -31,9 +31,23 @@
 #include <chrono>
 #include <random>
 #include <iostream>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <boost/test/floating_point_comparison.hpp>
+#include <alea/async_engine.hpp>
+#include <alea/buffered_engine.hpp>
+#include <alea/monte_carlo.hpp>
+#include <alea/parallel_fill.hpp>
 #include <alea/random.hpp>
+#include <alea/random_engine_mapper.hpp>
+#include <alea/shared_counter_stream.hpp>
+#include <alea/stream_layout.hpp>
+#include <alea/thread_streams.hpp>
+#include <alea/variant_engine_mapper.hpp>
 
 
 using namespace std::chrono;
@@ -142,6 +156,52 @@ std::uint64_t test_random_minstd_rand(std::uint64_t iter) {
 }
 
 
+std::uint64_t test_random_xoshiro256ss(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    std::uniform_int_distribution<std::uint64_t> dist;
+
+    alea::xoshiro256ss xoshiro_engine;
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < iter; ++i) {
+        res += dist(xoshiro_engine);
+    }
+
+    t2 = cl::now();
+
+    std::cout << "xoshiro256ss: " << time_in_microseconds(t2 - t1) << std::endl;
+    return res;
+}
+
+
+std::uint64_t test_random_pcg64_dxsm(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    std::uniform_int_distribution<std::uint64_t> dist;
+
+    alea::pcg64_dxsm pcg_engine;
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < iter; ++i) {
+        res += dist(pcg_engine);
+    }
+
+    t2 = cl::now();
+
+    std::cout << "pcg64_dxsm: " << time_in_microseconds(t2 - t1) << std::endl;
+    return res;
+}
+
+
 std::uint64_t test_random_threefry4x64(std::uint64_t iter) {
 
     std::uint64_t res = 0;
@@ -189,6 +249,145 @@ std::uint64_t test_random_threefry2x64(std::uint64_t iter) {
 }
 
 
+std::uint64_t test_random_chacha8(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    std::uniform_int_distribution<std::uint64_t> dist;
+
+    alea::counter_engine<alea::chacha8> chacha_engine;
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < iter; ++i) {
+        res += dist(chacha_engine);
+    }
+
+    t2 = cl::now();
+
+    std::cout << "chacha8: " << time_in_microseconds(t2 - t1) << std::endl;
+    return res;
+}
+
+
+std::uint64_t test_random_ars4x32(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    std::uniform_int_distribution<std::uint64_t> dist;
+
+    alea::counter_engine<alea::ars4x32> ars_engine;
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < iter; ++i) {
+        res += dist(ars_engine);
+    }
+
+    t2 = cl::now();
+
+    std::cout << "ars4x32: " << time_in_microseconds(t2 - t1) << std::endl;
+    return res;
+}
+
+
+std::uint64_t test_random_squares64(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    std::uniform_int_distribution<std::uint64_t> dist;
+
+    alea::counter_engine<alea::squares64> squares_engine;
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < iter; ++i) {
+        res += dist(squares_engine);
+    }
+
+    t2 = cl::now();
+
+    std::cout << "squares64: " << time_in_microseconds(t2 - t1) << std::endl;
+    return res;
+}
+
+
+std::uint64_t test_random_splitmix64(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    std::uniform_int_distribution<std::uint64_t> dist;
+
+    alea::counter_engine<alea::splitmix64> splitmix_engine;
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < iter; ++i) {
+        res += dist(splitmix_engine);
+    }
+
+    t2 = cl::now();
+
+    std::cout << "splitmix64: " << time_in_microseconds(t2 - t1) << std::endl;
+    return res;
+}
+
+
+std::uint64_t test_random_philox4x64(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    std::uniform_int_distribution<std::uint64_t> dist;
+
+    alea::counter_engine<alea::philox4x64> philox_engine;
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < iter; ++i) {
+        res += dist(philox_engine);
+    }
+
+    t2 = cl::now();
+
+    std::cout << "philox4x64: " << time_in_microseconds(t2 - t1) << std::endl;
+    return res;
+}
+
+
+
+std::uint64_t test_random_philox4x32(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    std::uniform_int_distribution<std::uint64_t> dist;
+
+    alea::counter_engine<alea::philox4x32> philox_engine;
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < iter; ++i) {
+        res += dist(philox_engine);
+    }
+
+    t2 = cl::now();
+
+    std::cout << "philox4x32: " << time_in_microseconds(t2 - t1) << std::endl;
+    return res;
+}
+
+
 std::uint64_t test_random_threefry_block_fake(std::uint64_t iter) {
 
     std::uint64_t res = 0;
@@ -219,26 +418,939 @@ std::uint64_t test_random_threefry_block_fake(std::uint64_t iter) {
 }
 
 
-int main() {
+// encrypt iter * 8 bytes of random data with the bulk block interface
+// of Cipher, the same amount of data for every cipher
+template <typename Cipher>
+std::uint64_t test_random_bulk_blocks(const std::string &name,
+                                      std::uint64_t iter) {
 
-    const std::uint64_t n_exec = 10000000;
-    std::uint64_t junk = 0;
+    typedef typename Cipher::uint_type uint_type;
 
-    std::cout << "generation of " << n_exec << " random numbers" << std::endl;
+    std::uint64_t res = 0;
 
-    junk += test_random_mersenne_twister(n_exec);
+    tp t1, t2;
 
-    junk += test_random_ranlux(n_exec);
+    Cipher cipher;
+    typename Cipher::domain_type counter;
+    counter.fill(0);
 
-    junk += test_random_mersenne_twister64(n_exec);
+    const std::uint64_t size_block =
+        std::tuple_size<typename Cipher::range_type>::value;
+    const std::uint64_t n_blocks = 1024;
+    const std::uint64_t n_bytes = iter * sizeof(std::uint64_t);
+    std::vector<uint_type> buffer(n_blocks * size_block);
 
-    junk += test_random_minstd_rand(n_exec);
+    t1 = cl::now();
 
-    junk += test_random_threefry4x64(n_exec);
+    for (std::uint64_t i = 0; i < n_bytes;
+         i += n_blocks * size_block * sizeof(uint_type)) {
+        cipher(counter, buffer.data(), n_blocks);
+        counter[0] += n_blocks;
+        res += buffer[0];
+    }
 
-    junk += test_random_threefry2x64(n_exec);
+    t2 = cl::now();
 
-    junk += test_random_threefry_block_fake(n_exec);
+    std::cout << name << " bulk blocks: " << time_in_microseconds(t2 - t1)
+              << std::endl;
+    return res;
+}
+
+
+std::uint64_t test_random_threefry_fill(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    alea::counter_engine<alea::threefry4x64> threefry_engine;
+
+    const std::uint64_t n_values = 4096;
+    std::vector<std::uint64_t> buffer(n_values);
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < iter; i += n_values) {
+        threefry_engine.fill(buffer.data(), buffer.data() + n_values);
+        res += buffer[0];
+    }
+
+    t2 = cl::now();
+
+    std::cout << "threefry4x64 fill: " << time_in_microseconds(t2 - t1)
+              << std::endl;
+    return res;
+}
+
+
+// one engine per entity, draw one value from each of the n_entities streams
+std::uint64_t test_random_entity_streams(std::uint64_t n_entities) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    typedef alea::compact_counter_engine<alea::threefry4x64> compact_type;
+
+    {
+        std::vector<engine_type> engines;
+        engines.reserve(n_entities);
+        for (std::uint64_t i = 0; i < n_entities; ++i) {
+            engines.emplace_back(i);
+        }
+
+        t1 = cl::now();
+
+        for (engine_type &engine : engines) {
+            res += engine();
+        }
+
+        t2 = cl::now();
+
+        std::cout << "counter_engine entity streams ("
+                  << sizeof(engine_type) * n_entities / (1024 * 1024)
+                  << " MiB): " << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    {
+        const alea::threefry4x64 cipher;
+        std::vector<compact_type> engines;
+        engines.reserve(n_entities);
+        for (std::uint64_t i = 0; i < n_entities; ++i) {
+            engines.emplace_back(cipher, compact_type::index_type(i));
+        }
+
+        t1 = cl::now();
+
+        for (compact_type &engine : engines) {
+            res += engine();
+        }
+
+        t2 = cl::now();
+
+        std::cout << "compact_counter_engine entity streams ("
+                  << sizeof(compact_type) * n_entities / (1024 * 1024)
+                  << " MiB): " << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    return res;
+}
+
+// one value per entity key at the same counter
+template <typename Cipher>
+std::uint64_t test_random_keyed_batch(const std::string &name,
+                                      std::uint64_t n_entities) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    std::vector<typename Cipher::key_type> keys(n_entities);
+    for (std::uint64_t i = 0; i < n_entities; ++i) {
+        keys[i].fill(0);
+        keys[i][0] = i;
+    }
+
+    std::vector<typename Cipher::range_type> out(n_entities);
+    typename Cipher::domain_type ctr;
+    ctr.fill(0);
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < n_entities; ++i) {
+        const Cipher cipher(keys[i]);
+        out[i] = cipher(ctr);
+    }
+
+    t2 = cl::now();
+
+    res += out[n_entities / 2][0];
+    std::cout << name << " per entity cipher: " << time_in_microseconds(t2 - t1)
+              << std::endl;
+
+    const alea::keyed_batch<Cipher> batch(keys.data(), n_entities);
+
+    t1 = cl::now();
+
+    batch(ctr, out.data());
+
+    t2 = cl::now();
+
+    res += out[n_entities / 2][0];
+    std::cout << name << " keyed_batch ("
+              << alea::impl::simd_isa_name(alea::impl::simd_isa_best())
+              << "): " << time_in_microseconds(t2 - t1) << std::endl;
+
+    return res;
+}
+
+// n_children child streams of a root key
+std::uint64_t test_random_child_keys(std::uint64_t n_children) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+
+    {
+        const engine_type root(42);
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < n_children; ++i) {
+            res += root.derivate(i)();
+        }
+
+        t2 = cl::now();
+
+        std::cout << "counter_engine derivate children: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    {
+        const alea::threefry4x64::key_type root = {{42, 0, 0, 0}};
+        std::vector<alea::threefry4x64::key_type> children(n_children);
+
+        t1 = cl::now();
+
+        alea::split(root, children.data(), n_children);
+
+        t2 = cl::now();
+
+        res += children[n_children / 2][0];
+        std::cout << "split children: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    return res;
+}
+
+std::uint64_t test_random_generic_derivate(std::uint64_t n_children) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    const std::mt19937 root(42);
+
+    {
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < n_children; ++i) {
+            std::mt19937 child(root);
+            std::seed_seq seq{std::uint32_t(child()), std::uint32_t(i)};
+            child.seed(seq);
+            res += child();
+        }
+
+        t2 = cl::now();
+
+        std::cout << "mersenne_twister std::seed_seq children: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    {
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < n_children; ++i) {
+            res += alea::random_engine_derivate(root, i)();
+        }
+
+        t2 = cl::now();
+
+        std::cout << "mersenne_twister derivate children: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    return res;
+}
+
+// runtime selected engine: virtual mapper against variant mapper
+// with a fast engine, to measure the dispatch cost
+std::uint64_t test_random_engine_mappers(std::uint64_t iter) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    typedef alea::xoshiro256ss engine_type;
+
+    {
+        alea::random_engine_mapper_64 mapper{engine_type()};
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < iter; ++i) {
+            res += mapper();
+        }
+
+        t2 = cl::now();
+
+        std::cout << "random_engine_mapper: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    {
+        alea::random_engine_mapper_64 mapper{engine_type()};
+        std::vector<std::uint64_t> values(1024);
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < iter; i += values.size()) {
+            mapper.fill(values.data(), values.size());
+            res += values[i % values.size()];
+        }
+
+        t2 = cl::now();
+
+        std::cout << "random_engine_mapper fill: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    {
+        // large state, not saved before each batch for derivate()
+        alea::random_engine_mapper_64 mapper{std::mt19937_64()};
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < iter; ++i) {
+            res += mapper();
+        }
+
+        t2 = cl::now();
+
+        std::cout << "random_engine_mapper mt19937_64: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    {
+        alea::variant_engine_mapper_64 mapper{engine_type()};
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < iter; ++i) {
+            res += mapper();
+        }
+
+        t2 = cl::now();
+
+        std::cout << "variant_engine_mapper: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    {
+        alea::variant_engine_mapper_64 mapper{engine_type()};
+        std::vector<std::uint64_t> values(1024);
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < iter; i += values.size()) {
+            mapper.fill(values.begin(), values.end());
+            res += values[i % values.size()];
+        }
+
+        t2 = cl::now();
+
+        std::cout << "variant_engine_mapper fill: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    return res;
+}
+
+// one child mapper derivated per task, from a root mapper without
+// buffered values and from a root mapper already drawn from, as a task
+// scheduler does
+//
+// Without buffered values a child costs one engine derivation and one
+// placement or allocation of the child engine. With buffered values it
+// costs in addition a copy of the engine saved before the batch and up to
+// buffer_size steps of the copy to the position of the root mapper
+template <typename Mapper>
+std::uint64_t test_random_mapper_derivate(const std::string &name,
+                                          std::uint64_t n_tasks,
+                                          std::pmr::memory_resource *resource) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    Mapper drawn(alea::xoshiro256ss(42), resource);
+    const Mapper root(drawn);
+    res += drawn();
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < n_tasks; ++i) {
+        Mapper child = root.derivate(i);
+        res += child();
+    }
+
+    t2 = cl::now();
+
+    std::cout << name << " derivate per task: "
+              << time_in_microseconds(t2 - t1) << std::endl;
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < n_tasks; ++i) {
+        Mapper child = drawn.derivate(i);
+        res += child();
+    }
+
+    t2 = cl::now();
+
+    std::cout << name << " derivate per task, buffered: "
+              << time_in_microseconds(t2 - t1) << std::endl;
+    return res;
+}
+
+// skip n values of a standard engine with discard and with alea::jump
+template <typename Engine>
+std::uint64_t test_random_jump(const std::string &name, std::uint64_t n) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    Engine discarded, jumped;
+
+    t1 = cl::now();
+
+    discarded.discard(n);
+
+    t2 = cl::now();
+
+    res += discarded();
+    std::cout << name << " discard: " << time_in_microseconds(t2 - t1)
+              << std::endl;
+
+    t1 = cl::now();
+
+    alea::jump(jumped, n);
+
+    t2 = cl::now();
+
+    res += jumped();
+    std::cout << name << " jump: " << time_in_microseconds(t2 - t1)
+              << std::endl;
+
+    return res;
+}
+
+// fill n values of a counter_engine serially and with parallel_fill
+std::uint64_t test_random_parallel_fill(std::uint64_t n) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    std::vector<engine_type::result_type> values(n);
+
+    {
+        engine_type engine(42);
+
+        t1 = cl::now();
+
+        engine.fill(values.begin(), values.end());
+
+        t2 = cl::now();
+
+        res += values[n / 2];
+        std::cout << "serial fill: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    {
+        engine_type engine(42);
+        alea::thread_pool pool;
+
+        t1 = cl::now();
+
+        alea::parallel_fill(engine, values.begin(), values.end(), pool);
+
+        t2 = cl::now();
+
+        res += values[n / 2];
+        std::cout << "parallel_fill " << pool.concurrency()
+                  << " threads: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    return res;
+}
+
+// n values drawn from one stream by 1 to max_threads threads, through
+// a mutex around a counter_engine and through shared_counter_stream
+std::uint64_t test_random_shared_stream(std::uint64_t n,
+                                        std::size_t max_threads) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    typedef alea::shared_counter_stream<alea::threefry4x64> shared_type;
+
+    for (std::size_t n_threads = 1; n_threads <= max_threads;
+         n_threads *= 2) {
+        std::vector<std::uint64_t> sums(n_threads);
+        std::vector<std::thread> threads;
+
+        {
+            engine_type engine(42);
+            std::mutex mutex;
+
+            t1 = cl::now();
+
+            for (std::size_t t = 0; t < n_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    for (std::uint64_t i = 0; i < n / n_threads; ++i) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        sums[t] += engine();
+                    }
+                });
+            }
+            for (std::thread &thread : threads) {
+                thread.join();
+            }
+
+            t2 = cl::now();
+
+            threads.clear();
+            std::cout << "locked counter_engine " << n_threads
+                      << " threads: " << time_in_microseconds(t2 - t1)
+                      << std::endl;
+        }
+
+        {
+            shared_type shared(engine_type::key_type{{42, 0, 0, 0}});
+
+            t1 = cl::now();
+
+            for (std::size_t t = 0; t < n_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    shared_type::local_stream stream = shared.local();
+                    for (std::uint64_t i = 0; i < n / n_threads; ++i) {
+                        sums[t] += stream();
+                    }
+                });
+            }
+            for (std::thread &thread : threads) {
+                thread.join();
+            }
+
+            t2 = cl::now();
+
+            threads.clear();
+            const alea::shared_stream_stats stats = shared.stats();
+            std::cout << "shared_counter_stream " << n_threads
+                      << " threads: " << time_in_microseconds(t2 - t1)
+                      << " ( " << stats.leases << " leases, "
+                      << stats.interleaved << " interleaved )" << std::endl;
+        }
+
+        for (std::uint64_t sum : sums) {
+            res += sum;
+        }
+    }
+
+    return res;
+}
+
+// n values per thread drawn from per thread engines stored in a plain
+// vector and in thread_streams
+template <typename Engine>
+std::uint64_t test_random_thread_streams(const std::string &name,
+                                         std::uint64_t n,
+                                         std::size_t n_threads) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    const Engine root(42);
+    std::vector<std::uint64_t> sums(n_threads);
+    std::vector<std::thread> threads;
+
+    {
+        std::vector<Engine> engines;
+        for (std::size_t t = 0; t < n_threads; ++t) {
+            engines.push_back(alea::random_engine_derivate(
+                root, typename Engine::result_type(t)));
+        }
+
+        t1 = cl::now();
+
+        for (std::size_t t = 0; t < n_threads; ++t) {
+            threads.emplace_back([&, t] {
+                std::uint64_t sum = 0;
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    sum += engines[t]();
+                }
+                sums[t] += sum;
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        t2 = cl::now();
+
+        threads.clear();
+        std::cout << name << " vector " << n_threads
+                  << " threads: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    {
+        alea::thread_streams<Engine> streams(root, n_threads);
+
+        t1 = cl::now();
+
+        for (std::size_t t = 0; t < n_threads; ++t) {
+            threads.emplace_back([&, t] {
+                alea::set_worker_index(t);
+                Engine &engine = streams.local();
+                std::uint64_t sum = 0;
+                for (std::uint64_t i = 0; i < n; ++i) {
+                    sum += engine();
+                }
+                sums[t] += sum;
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+
+        t2 = cl::now();
+
+        threads.clear();
+        std::cout << name << " thread_streams " << n_threads
+                  << " threads: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    for (std::uint64_t sum : sums) {
+        res += sum;
+    }
+    return res;
+}
+
+// pi estimate from n samples, with one serial engine and with
+// monte_carlo on the default pool
+std::uint64_t test_random_monte_carlo(std::uint64_t n) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    std::uniform_real_distribution<double> dist;
+
+    {
+        engine_type engine(42);
+
+        t1 = cl::now();
+
+        double inside = 0;
+        for (std::uint64_t i = 0; i < n; ++i) {
+            const double x = dist(engine), y = dist(engine);
+            inside += x * x + y * y < 1 ? 1.0 : 0.0;
+        }
+
+        t2 = cl::now();
+
+        res += std::uint64_t(inside);
+        std::cout << "serial pi: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    {
+        t1 = cl::now();
+
+        const double inside = alea::monte_carlo(
+            n,
+            [](std::uint64_t, engine_type &engine) {
+                std::uniform_real_distribution<double> sample_dist;
+                const double x = sample_dist(engine), y = sample_dist(engine);
+                return x * x + y * y < 1 ? 1.0 : 0.0;
+            },
+            std::plus<double>(), {{42}});
+
+        t2 = cl::now();
+
+        res += std::uint64_t(inside);
+        std::cout << "monte_carlo pi "
+                  << alea::default_thread_pool().concurrency()
+                  << " threads: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    return res;
+}
+
+// engines of n (job, rank, thread) ids built from a stream_layout
+std::uint64_t test_random_stream_layout(std::uint64_t n) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    typedef alea::stream_layout<alea::threefry4x64, alea::key_field<24>,
+                                alea::key_field<16>, alea::key_field<12>>
+        layout;
+    const layout::key_type seed = {{42, 0, 0, 0}};
+
+    t1 = cl::now();
+
+    for (std::uint64_t i = 0; i < n; ++i) {
+        layout::engine_type engine =
+            layout::engine(seed, i >> 16, (i >> 4) & 0xFFF, i & 0xF);
+        res += engine();
+    }
+
+    t2 = cl::now();
+
+    std::cout << "stream_layout engines: " << time_in_microseconds(t2 - t1)
+              << std::endl;
+
+    return res;
+}
+
+// n values drawn from a counter_engine and from its async_engine
+std::uint64_t test_random_async_engine(std::uint64_t n) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+
+    {
+        engine_type engine(42);
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < n; ++i) {
+            res += engine();
+        }
+
+        t2 = cl::now();
+
+        std::cout << "counter_engine draws: " << time_in_microseconds(t2 - t1)
+                  << std::endl;
+    }
+
+    {
+        alea::async_engine<engine_type> engine{engine_type(42)};
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < n; ++i) {
+            res += engine();
+        }
+
+        t2 = cl::now();
+
+        const alea::async_engine_stats stats = engine.stats();
+        std::cout << "async_engine draws: " << time_in_microseconds(t2 - t1)
+                  << " ( " << stats.consumer_stalls << " stalls, "
+                  << stats.producer_waits << " producer waits )"
+                  << std::endl;
+    }
+
+    return res;
+}
+
+// n values and n uniform doubles from a counter_engine and from its
+// buffered_engine
+template <typename CBRNG>
+std::uint64_t test_random_buffered_engine(const std::string &name,
+                                          std::uint64_t n) {
+
+    std::uint64_t res = 0;
+
+    tp t1, t2;
+
+    typedef alea::counter_engine<CBRNG> engine_type;
+    std::uniform_real_distribution<double> dist;
+
+    {
+        engine_type engine(42);
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < n; ++i) {
+            res += engine();
+        }
+
+        t2 = cl::now();
+
+        std::cout << name << " counter_engine: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+
+        double sum = 0;
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < n; ++i) {
+            sum += dist(engine);
+        }
+
+        t2 = cl::now();
+
+        res += std::uint64_t(sum);
+        std::cout << name << " counter_engine uniform: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    {
+        alea::buffered_engine<engine_type> engine{engine_type(42)};
+
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < n; ++i) {
+            res += engine();
+        }
+
+        t2 = cl::now();
+
+        std::cout << name << " buffered_engine: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+
+        double sum = 0;
+        t1 = cl::now();
+
+        for (std::uint64_t i = 0; i < n; ++i) {
+            sum += dist(engine);
+        }
+
+        t2 = cl::now();
+
+        res += std::uint64_t(sum);
+        std::cout << name << " buffered_engine uniform: "
+                  << time_in_microseconds(t2 - t1) << std::endl;
+    }
+
+    return res;
+}
+
+
+int main() {
+
+    const std::uint64_t n_exec = 10000000;
+    std::uint64_t junk = 0;
+
+    std::cout << "generation of " << n_exec << " random numbers" << std::endl;
+
+    junk += test_random_mersenne_twister(n_exec);
+
+    junk += test_random_ranlux(n_exec);
+
+    junk += test_random_mersenne_twister64(n_exec);
+
+    junk += test_random_minstd_rand(n_exec);
+
+    junk += test_random_xoshiro256ss(n_exec);
+
+    junk += test_random_pcg64_dxsm(n_exec);
+
+    junk += test_random_threefry4x64(n_exec);
+
+    junk += test_random_threefry2x64(n_exec);
+
+    junk += test_random_chacha8(n_exec);
+
+    junk += test_random_ars4x32(n_exec);
+
+    junk += test_random_squares64(n_exec);
+
+    junk += test_random_splitmix64(n_exec);
+
+    junk += test_random_philox4x64(n_exec);
+
+    junk += test_random_philox4x32(n_exec);
+
+    junk += test_random_threefry_block_fake(n_exec);
+
+    const std::string simd_isa =
+        alea::impl::simd_isa_name(alea::impl::simd_isa_best());
+    const std::string aes_impl =
+        alea::impl::aes_impl_name(alea::impl::aes_impl_best());
+
+    junk += test_random_bulk_blocks<alea::threefry4x64>(
+        "threefry4x64 (" + simd_isa + ")", n_exec);
+
+    junk += test_random_bulk_blocks<alea::chacha8>(
+        "chacha8 (" + simd_isa + ")", n_exec);
+
+    junk += test_random_bulk_blocks<alea::chacha20>(
+        "chacha20 (" + simd_isa + ")", n_exec);
+
+    junk += test_random_bulk_blocks<alea::ars4x32>(
+        "ars4x32 (" + aes_impl + ")", n_exec);
+
+    junk += test_random_bulk_blocks<alea::squares64>("squares64", n_exec);
+
+    junk += test_random_bulk_blocks<alea::splitmix64>("splitmix64", n_exec);
+
+    junk += test_random_threefry_fill(n_exec);
+
+    junk += test_random_entity_streams(n_exec);
+
+    junk += test_random_keyed_batch<alea::threefry4x64>("threefry4x64", n_exec);
+    junk += test_random_keyed_batch<alea::threefry2x32>("threefry2x32", n_exec);
+
+    junk += test_random_child_keys(n_exec);
+
+    junk += test_random_generic_derivate(n_exec / 100);
+
+    junk += test_random_engine_mappers(n_exec);
+
+    junk += test_random_jump<std::minstd_rand>("minstd_rand", n_exec * 10);
+    junk += test_random_jump<std::mt19937>("mersenne_twister", n_exec * 10);
+    junk +=
+        test_random_jump<std::mt19937_64>("mersenne_twister64", n_exec * 10);
+
+    junk += test_random_parallel_fill(n_exec * 10);
+
+    junk += test_random_monte_carlo(n_exec);
+
+    junk += test_random_stream_layout(n_exec);
+
+    junk += test_random_async_engine(n_exec);
+
+    junk += test_random_buffered_engine<alea::threefry4x64>("threefry4x64",
+                                                           n_exec);
+    junk += test_random_buffered_engine<alea::philox4x32>("philox4x32", n_exec);
+
+    junk += test_random_shared_stream(
+        n_exec, std::max<std::size_t>(std::thread::hardware_concurrency(), 4));
+
+    junk += test_random_thread_streams<alea::xoshiro256ss>(
+        "xoshiro256ss", n_exec,
+        std::max<std::size_t>(std::thread::hardware_concurrency(), 4));
+    junk += test_random_thread_streams<alea::counter_engine<alea::philox4x32>>(
+        "philox4x32", n_exec,
+        std::max<std::size_t>(std::thread::hardware_concurrency(), 4));
+
+    // engine allocated for each derivation, as without inline storage
+    junk += test_random_mapper_derivate<
+        alea::random_engine_mapper<std::uint64_t, 8>>(
+        "random_engine_mapper heap", n_exec / 10,
+        std::pmr::new_delete_resource());
+    {
+        std::pmr::unsynchronized_pool_resource pool;
+        junk += test_random_mapper_derivate<
+            alea::random_engine_mapper<std::uint64_t, 8>>(
+            "random_engine_mapper pool", n_exec / 10, &pool);
+    }
+    junk += test_random_mapper_derivate<alea::random_engine_mapper_64>(
+        "random_engine_mapper inline", n_exec / 10,
+        std::pmr::get_default_resource());
 
 
     std::cout << "accumulation: " << junk << std::endl;
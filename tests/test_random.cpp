@@ -29,12 +29,28 @@
 #define BOOST_TEST_MODULE randomTests
 #define BOOST_TEST_MAIN
 
+#include <alea/async_engine.hpp>
+#include <alea/buffered_engine.hpp>
+#include <alea/monte_carlo.hpp>
+#include <alea/parallel_fill.hpp>
 #include <alea/random.hpp>
 #include <alea/random_engine_mapper.hpp>
+#include <alea/shared_counter_stream.hpp>
+#include <alea/stream_layout.hpp>
+#include <alea/thread_streams.hpp>
+#include <alea/variant_engine_mapper.hpp>
 #include <boost/mpl/list.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory_resource>
+#include <set>
+#include <sstream>
+#include <thread>
+
 BOOST_AUTO_TEST_CASE(simple_random_tests) {
     const std::uint64_t n_vals = 1000;
 
@@ -289,6 +305,32 @@ typedef boost::mpl::list<alea::threefry2x32, alea::threefry4x32,
                          alea::threefry2x64, alea::threefry4x64>
     threefry_types;
 
+typedef boost::mpl::list<alea::philox2x32, alea::philox4x32, alea::philox2x64,
+                         alea::philox4x64>
+    philox_types;
+
+typedef boost::mpl::list<alea::chacha8, alea::chacha12, alea::chacha20>
+    chacha_types;
+
+// all the counter based generators usable with counter_engine
+typedef boost::mpl::list<alea::threefry2x32, alea::threefry4x32,
+                         alea::threefry2x64, alea::threefry4x64,
+                         alea::philox2x32, alea::philox4x32,
+                         alea::philox2x64, alea::philox4x64, alea::chacha8,
+                         alea::chacha12, alea::chacha20, alea::ars4x32,
+                         alea::squares32, alea::squares64, alea::splitmix64>
+    cbrng_types;
+
+// lightweight counter hash generators
+typedef boost::mpl::list<alea::squares32, alea::squares64, alea::splitmix64>
+    counter_hash_types;
+
+// counter based generators with multi-lane bulk kernels
+typedef boost::mpl::list<alea::threefry2x32, alea::threefry4x32,
+                         alea::threefry2x64, alea::threefry4x64,
+                         alea::chacha8, alea::chacha12, alea::chacha20>
+    simd_cbrng_types;
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(threefry_distribute, T, threefry_types) {
     boost::random::uniform_int_distribution<boost::uint64_t> dist100(0, 100);
 
@@ -306,7 +348,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(threefry_distribute, T, threefry_types) {
     BOOST_CHECK_LE(mean, 51);
 }
 
-BOOST_AUTO_TEST_CASE_TEMPLATE(engine_discard, T, threefry_types) {
+BOOST_AUTO_TEST_CASE_TEMPLATE(engine_discard, T, cbrng_types) {
     // basic consistency test
     {
         alea::counter_engine<T> threefry_engine, threefry_engine_origin,
@@ -404,3 +446,2204 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(engine_discard, T, threefry_types) {
         BOOST_CHECK_EQUAL(threefry_engine(), threefry_engine_clone());
     }
 }
+
+BOOST_AUTO_TEST_CASE(engine_discard_negative) {
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    engine_type engine(42), reference(42);
+
+    // signed skips are accepted, the negative ones rejected
+    engine.discard(5);
+    reference.discard(5u);
+    BOOST_CHECK_THROW(engine.discard(-1), std::invalid_argument);
+    BOOST_CHECK(engine == reference);
+
+    alea::buffered_engine<engine_type> buffered(engine);
+    BOOST_CHECK_THROW(buffered.discard(-3), std::invalid_argument);
+    BOOST_CHECK(buffered.engine() == reference);
+
+    std::mt19937 twister;
+    BOOST_CHECK_THROW(alea::jump(twister, -1), std::invalid_argument);
+    BOOST_CHECK(twister == std::mt19937());
+}
+
+BOOST_AUTO_TEST_CASE(engine_discard_domain) {
+    // the jumps stay below the domain byte of the counter
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    engine_type engine(42), reference(42);
+    (void)engine();
+    (void)reference();
+
+    engine_type::ctr_type blocks = {{0, 0, 0, std::uint64_t(1) << 56}};
+    BOOST_CHECK_THROW(engine.discard_blocks(blocks), std::out_of_range);
+    BOOST_CHECK(engine == reference);
+
+    blocks = {{0, 0, 0, (std::uint64_t(1) << 56) - 1}};
+    engine.discard_blocks(blocks);
+    BOOST_CHECK(alea::impl::counter_domain(engine.getcounter()) == 0);
+
+#ifdef __SIZEOF_INT128__
+    typedef alea::counter_engine<alea::philox2x64> wide_type;
+    wide_type wide(7), wide_reference(7);
+    const __uint128_t to_domain = (__uint128_t(1) << 120) * 2;
+    BOOST_CHECK_THROW(wide.discard(to_domain), std::out_of_range);
+    BOOST_CHECK(wide == wide_reference);
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(threefry_known_answer) {
+    // known answer vectors from the Random123 distribution (kat_vectors)
+    {
+        alea::threefry4x64 cipher;
+        const alea::threefry4x64::range_type res = cipher({{0, 0, 0, 0}});
+        const alea::threefry4x64::range_type expected = {
+            {0x09218ebde6c85537ULL, 0x55941f5266d86105ULL,
+             0x4bd25e16282434dcULL, 0xee29ec846bd2e40bULL}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        const std::uint64_t ff = ~std::uint64_t(0);
+        const alea::threefry4x64::key_type key = {{ff, ff, ff, ff}};
+        alea::threefry4x64 cipher(key);
+        const alea::threefry4x64::range_type res = cipher({{ff, ff, ff, ff}});
+        const alea::threefry4x64::range_type expected = {
+            {0x29c24097942bba1bULL, 0x0371bbfb0f6f4e11ULL,
+             0x3c231ffa33f83a1cULL, 0xcd29113fde32d168ULL}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        alea::threefry2x64 cipher;
+        const alea::threefry2x64::range_type res = cipher({{0, 0}});
+        const alea::threefry2x64::range_type expected = {
+            {0xc2b6e3a8c2c69865ULL, 0x6f81ed42f350084dULL}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        alea::threefry4x32 cipher;
+        const alea::threefry4x32::range_type res = cipher({{0, 0, 0, 0}});
+        const alea::threefry4x32::range_type expected = {
+            {0x9c6ca96a, 0xe17eae66, 0xfc10ecd4, 0x5256a7d8}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        alea::threefry2x32 cipher;
+        const alea::threefry2x32::range_type res = cipher({{0, 0}});
+        const alea::threefry2x32::range_type expected = {
+            {0x6b200159, 0x99ba4efe}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+}
+
+namespace {
+
+// Zobrist like table computed by the compiler
+template <std::size_t Size>
+constexpr std::array<std::uint64_t, Size> constexpr_table(std::uint64_t seed) {
+    alea::counter_engine<alea::threefry4x64> engine(seed);
+    std::array<std::uint64_t, Size> table{};
+    for (std::size_t i = 0; i < Size; ++i) {
+        table[i] = engine();
+    }
+    return table;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(threefry_constexpr) {
+    constexpr alea::threefry4x64 cipher;
+    constexpr alea::threefry4x64::range_type block = cipher({{0, 0, 0, 0}});
+    static_assert(block[0] == 0x09218ebde6c85537ULL &&
+                      block[3] == 0xee29ec846bd2e40bULL,
+                  "threefry4x64 known answer at compile time");
+
+    constexpr alea::threefry2x32::range_type block32 =
+        alea::threefry2x32()({{0, 0}});
+    static_assert(block32[0] == 0x6b200159 && block32[1] == 0x99ba4efe,
+                  "threefry2x32 known answer at compile time");
+
+    // the compile time table matches the runtime stream
+    constexpr std::array<std::uint64_t, 67> table = constexpr_table<67>(42);
+    alea::counter_engine<alea::threefry4x64> engine(42);
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        BOOST_CHECK_EQUAL(table[i], engine());
+    }
+
+    constexpr alea::counter_engine<alea::threefry4x64> seeded(42);
+    static_assert(seeded.at(66) == table[66], "random access at compile time");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(simd_kernels, T, simd_cbrng_types) {
+    typedef typename T::uint_type uint_type;
+    typedef typename T::domain_type domain_type;
+
+    const std::size_t nblocks = 1001;
+    const std::size_t n = std::tuple_size<typename T::range_type>::value;
+
+    typename T::key_type key;
+    for (std::size_t i = 0; i < key.size(); ++i) {
+        key[i] = uint_type(0x243f6a8885a308d3ULL * (i + 1));
+    }
+    T cipher(key);
+
+    // start close to the wrap around of the first counter word
+    // to exercise the carry propagation between blocks
+    domain_type start;
+    start.fill(0);
+    start[0] = std::numeric_limits<uint_type>::max() - 17;
+
+    std::vector<uint_type> reference(nblocks * n);
+    domain_type ctr = start;
+    for (std::size_t b = 0; b < nblocks; ++b) {
+        const typename T::range_type block = cipher(ctr);
+        std::copy(block.begin(), block.end(), reference.begin() + b * n);
+
+        for (std::size_t w = 0; w < ctr.size() && ++ctr[w] == 0; ++w) {
+        }
+    }
+
+    for (alea::impl::simd_isa isa :
+         {alea::impl::simd_isa::scalar, alea::impl::simd_isa::sse2,
+          alea::impl::simd_isa::avx2, alea::impl::simd_isa::avx512}) {
+        if (!alea::impl::simd_isa_supported(isa)) {
+            std::cout << "simd kernel not supported: "
+                      << alea::impl::simd_isa_name(isa) << "\n";
+            continue;
+        }
+
+        std::vector<uint_type> res(nblocks * n);
+        cipher.encrypt_blocks(isa, start, res.data(), nblocks);
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      reference.begin(), reference.end());
+    }
+
+    // runtime dispatched version
+    std::vector<uint_type> res(nblocks * n);
+    cipher(start, res.data(), nblocks);
+    BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), reference.begin(),
+                                  reference.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(engine_fill, T, cbrng_types) {
+    typedef alea::counter_engine<T> engine_type;
+    typedef typename engine_type::result_type result_type;
+
+    // various start offsets in the buffered block and sizes
+    // non multiple of the block size
+    for (std::size_t skip : {0, 1, 3}) {
+        for (std::size_t n : {0, 1, 5, 64, 1001}) {
+            engine_type engine(42), engine_bulk(42), engine_iter(42);
+            for (std::size_t i = 0; i < skip; ++i) {
+                (void)engine();
+                (void)engine_bulk();
+                (void)engine_iter();
+            }
+
+            std::vector<result_type> reference(n), bulk(n);
+            std::generate(reference.begin(), reference.end(),
+                          std::ref(engine));
+
+            // contiguous destination
+            engine_bulk.fill(bulk.data(), bulk.data() + n);
+            BOOST_CHECK_EQUAL_COLLECTIONS(bulk.begin(), bulk.end(),
+                                          reference.begin(), reference.end());
+            BOOST_CHECK(engine == engine_bulk);
+
+            // generic output iterator
+            std::vector<result_type> iter;
+            engine_iter.generate_n(std::back_inserter(iter), n);
+            BOOST_CHECK_EQUAL_COLLECTIONS(iter.begin(), iter.end(),
+                                          reference.begin(), reference.end());
+            BOOST_CHECK(engine == engine_iter);
+
+            const result_type next = engine();
+            BOOST_CHECK_EQUAL(next, engine_bulk());
+            BOOST_CHECK_EQUAL(next, engine_iter());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(philox_known_answer) {
+    // known answer vectors from the Random123 distribution (kat_vectors)
+    {
+        alea::philox2x32 cipher;
+        const alea::philox2x32::range_type res = cipher({{0, 0}});
+        const alea::philox2x32::range_type expected = {
+            {0xff1dae59, 0x6cd10df2}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        alea::philox4x32 cipher;
+        const alea::philox4x32::range_type res = cipher({{0, 0, 0, 0}});
+        const alea::philox4x32::range_type expected = {
+            {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        const alea::philox4x32::key_type key = {{0xa4093822, 0x299f31d0}};
+        alea::philox4x32 cipher(key);
+        const alea::philox4x32::range_type res =
+            cipher({{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}});
+        const alea::philox4x32::range_type expected = {
+            {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        alea::philox2x64 cipher;
+        const alea::philox2x64::range_type res = cipher({{0, 0}});
+        const alea::philox2x64::range_type expected = {
+            {0xca00a0459843d731ULL, 0x66c24222c9a845b5ULL}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        alea::philox4x64 cipher;
+        const alea::philox4x64::range_type res = cipher({{0, 0, 0, 0}});
+        const alea::philox4x64::range_type expected = {
+            {0x16554d9eca36314cULL, 0xdb20fe9d672d0fdcULL,
+             0xd7e772cee186176bULL, 0x7e68b68aec7ba23bULL}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(philox_distribute, T, philox_types) {
+    boost::random::uniform_int_distribution<boost::uint64_t> dist100(0, 100);
+
+    alea::counter_engine<T> philox_engine;
+
+    const std::uint64_t n_normalize = 100000;
+    std::uint64_t res = 0;
+    for (std::uint64_t i = 0; i < n_normalize; ++i) {
+        res += dist100(philox_engine);
+    }
+
+    const std::uint64_t mean = res / n_normalize;
+    std::cout << "n_normalize_philox: " << mean << "\n";
+    BOOST_CHECK_GE(mean, 49);
+    BOOST_CHECK_LE(mean, 51);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(engine_derivate, T, cbrng_types) {
+    alea::counter_engine<T> engine(1234);
+
+    alea::counter_engine<T> derivated_engine = engine.derivate(42),
+                            derivated_engine_same = engine.derivate(42),
+                            derivated_engine_differ = engine.derivate(43);
+
+    BOOST_CHECK(derivated_engine == derivated_engine_same);
+    BOOST_CHECK(derivated_engine != derivated_engine_differ);
+    BOOST_CHECK(derivated_engine != engine);
+
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        const typename alea::counter_engine<T>::result_type v =
+            derivated_engine();
+        BOOST_CHECK_EQUAL(v, derivated_engine_same());
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(engine_stream, T, cbrng_types) {
+    typedef alea::counter_engine<T> engine_type;
+
+    // at a block boundary and in the middle of a block
+    for (std::size_t drawn : {0, 1, 3}) {
+        engine_type engine(1234);
+        for (std::size_t i = 0; i < drawn; ++i) {
+            (void)engine();
+        }
+
+        std::stringstream ss;
+        ss << engine;
+        engine_type restored;
+        ss >> restored;
+        BOOST_CHECK(!ss.fail());
+        BOOST_CHECK(restored == engine);
+        for (int i = 0; i < 20; ++i) {
+            BOOST_CHECK_EQUAL(restored(), engine());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(threefry_seed_seq) {
+    const alea::threefry_seed_seq::key_type key = {{1, 2, 3, 4}};
+    alea::threefry_seed_seq seq(key), seq_same(key);
+
+    std::vector<std::uint32_t> words(100), words_same(100);
+    seq.generate(words.begin(), words.end());
+    seq_same.generate(words_same.begin(), words_same.end());
+    BOOST_CHECK(words == words_same);
+
+    // the words are the threefry4x64 stream of the key
+    const alea::threefry4x64::range_type block =
+        alea::threefry4x64(key)({{0, 0, 0, 0}});
+    for (std::size_t i = 0; i < 8; ++i) {
+        BOOST_CHECK_EQUAL(words[i],
+                          std::uint32_t(block[i / 2] >> (32 * (i % 2))));
+    }
+
+    // param gives back the key words
+    std::vector<std::uint32_t> param;
+    seq.param(std::back_inserter(param));
+    BOOST_CHECK_EQUAL(param.size(), seq.size());
+    alea::threefry_seed_seq seq_param(param.begin(), param.end());
+    BOOST_CHECK(seq_param.get_key() == key);
+
+    std::mt19937 twister, twister_same;
+    twister.seed(seq);
+    twister_same.seed(seq_same);
+    BOOST_CHECK(twister == twister_same);
+    BOOST_CHECK(twister != std::mt19937());
+}
+
+typedef boost::mpl::list<std::mt19937, std::mt19937_64, std::minstd_rand,
+                         std::ranlux24, boost::random::mt11213b>
+    generic_derivate_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(generic_derivate, T, generic_derivate_types) {
+    T engine(1234);
+
+    const T derivated_engine = alea::random_engine_derivate(engine, 42),
+            derivated_engine_same = alea::random_engine_derivate(engine, 42),
+            derivated_engine_differ = alea::random_engine_derivate(engine, 43);
+
+    BOOST_CHECK(derivated_engine == derivated_engine_same);
+    BOOST_CHECK(derivated_engine != derivated_engine_differ);
+    BOOST_CHECK(derivated_engine != engine);
+
+    // the parent is left untouched, but its state matters
+    BOOST_CHECK(engine == T(1234));
+    engine.discard(1);
+    BOOST_CHECK(alea::random_engine_derivate(engine, 42) != derivated_engine);
+
+    // adjacent keys give distinct children
+    std::set<typename T::result_type> firsts;
+    for (typename T::result_type key = 0; key < 256; ++key) {
+        T child = alea::random_engine_derivate(engine, key);
+        firsts.insert(child());
+    }
+    BOOST_CHECK_EQUAL(firsts.size(), 256);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(generic_derivate_independence, T,
+                              generic_derivate_types) {
+    const std::size_t n_vals = 4096;
+    const T engine(5489);
+
+    std::uniform_real_distribution<double> dist(0, 1);
+
+    for (typename T::result_type key = 0; key < 8; ++key) {
+        T child = alea::random_engine_derivate(engine, key),
+          neighbour = alea::random_engine_derivate(engine, key + 1);
+
+        double sum_x = 0, sum_y = 0, sum_xy = 0, sum_xx = 0, sum_yy = 0;
+        std::size_t same_half = 0;
+        for (std::size_t i = 0; i < n_vals; ++i) {
+            const double x = dist(child), y = dist(neighbour);
+            sum_x += x;
+            sum_y += y;
+            sum_xy += x * y;
+            sum_xx += x * x;
+            sum_yy += y * y;
+            same_half += ((x < 0.5) == (y < 0.5));
+        }
+
+        const double n = double(n_vals);
+        const double cov = sum_xy / n - (sum_x / n) * (sum_y / n);
+        const double var_x = sum_xx / n - (sum_x / n) * (sum_x / n);
+        const double var_y = sum_yy / n - (sum_y / n) * (sum_y / n);
+        const double correlation = cov / std::sqrt(var_x * var_y);
+
+        // 5 standard deviations of an independent pair
+        const double bound = 5 / std::sqrt(n);
+        BOOST_CHECK_LT(std::abs(correlation), bound);
+        BOOST_CHECK_LT(std::abs(sum_x / n - 0.5), bound);
+        BOOST_CHECK_LT(std::abs(double(same_half) / n - 0.5), bound);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(chacha_known_answer) {
+    // all zero key and counter, first block of the keystream
+    // for 8, 12 and 20 rounds
+    {
+        alea::chacha8 cipher;
+        const alea::chacha8::range_type res = cipher({{0, 0, 0, 0}});
+        const std::array<std::uint32_t, 4> expected = {
+            {0x2fef003e, 0xd6405f89, 0xe8b85b7f, 0xa1a5091f}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.begin() + 4,
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        alea::chacha12 cipher;
+        const alea::chacha12::range_type res = cipher({{0, 0, 0, 0}});
+        const std::array<std::uint32_t, 4> expected = {
+            {0x6a9af49b, 0x53f95507, 0x12ce1f81, 0xd583265f}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.begin() + 4,
+                                      expected.begin(), expected.end());
+    }
+
+    {
+        alea::chacha20 cipher;
+        const alea::chacha20::range_type res = cipher({{0, 0, 0, 0}});
+        const std::array<std::uint32_t, 4> expected = {
+            {0xade0b876, 0x903df1a0, 0xe56a5d40, 0x28bd8653}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.begin() + 4,
+                                      expected.begin(), expected.end());
+    }
+
+    // RFC 7539 section 2.3.2 block function test vector
+    {
+        alea::chacha20::key_type key;
+        for (std::uint32_t i = 0; i < key.size(); ++i) {
+            const std::uint32_t byte = 4 * i;
+            key[i] = byte | (byte + 1) << 8 | (byte + 2) << 16 |
+                     (byte + 3) << 24;
+        }
+        alea::chacha20 cipher(key);
+        const alea::chacha20::range_type res =
+            cipher({{0x00000001, 0x09000000, 0x4a000000, 0x00000000}});
+        const alea::chacha20::range_type expected = {
+            {0xe4e7f110, 0x15593bd1, 0x1fdd0f50, 0xc47120a3, 0xc7f4d1c7,
+             0x0368c033, 0x9aaa2204, 0x4e6cd4c3, 0x466482d2, 0x09aa9f07,
+             0x05d7c214, 0xa2028bd9, 0xd19c12b5, 0xb94e16de, 0xe883d0cb,
+             0x4e3c50a2}};
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      expected.begin(), expected.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(chacha_distribute, T, chacha_types) {
+    boost::random::uniform_int_distribution<boost::uint64_t> dist100(0, 100);
+
+    alea::counter_engine<T> chacha_engine;
+
+    const std::uint64_t n_normalize = 100000;
+    std::uint64_t res = 0;
+    for (std::uint64_t i = 0; i < n_normalize; ++i) {
+        res += dist100(chacha_engine);
+    }
+
+    const std::uint64_t mean = res / n_normalize;
+    std::cout << "n_normalize_chacha: " << mean << "\n";
+    BOOST_CHECK_GE(mean, 49);
+    BOOST_CHECK_LE(mean, 51);
+}
+
+BOOST_AUTO_TEST_CASE(aes_soft_rounds) {
+    // aesenc / aesenclast example of the Intel AES-NI white paper
+    const alea::impl::aes_block state = {
+        {0x5d53475d, 0x63746f72, 0x73745665, 0x7b5b5465}};
+    const alea::impl::aes_block round_key = {
+        {0x726f6e5d, 0x5b477565, 0x68617929, 0x48692853}};
+
+    const alea::impl::aes_block res =
+        alea::impl::aes_soft_round(state, round_key);
+    const alea::impl::aes_block expected = {
+        {0xded7e595, 0x8b104b58, 0x9fdba3c5, 0xa8311c2f}};
+    BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(), expected.begin(),
+                                  expected.end());
+
+    const alea::impl::aes_block res_last =
+        alea::impl::aes_soft_last_round(state, round_key);
+    const alea::impl::aes_block expected_last = {
+        {0x53fdc611, 0x177ec425, 0x938c5964, 0xc7fb881e}};
+    BOOST_CHECK_EQUAL_COLLECTIONS(res_last.begin(), res_last.end(),
+                                  expected_last.begin(), expected_last.end());
+}
+
+BOOST_AUTO_TEST_CASE(ars_aes_impls) {
+    const std::size_t nblocks = 1001;
+
+    const alea::ars4x32::key_type key = {
+        {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+    const alea::ars4x32 ciphers[] = {alea::ars4x32(), alea::ars4x32(key)};
+
+    // start close to the wrap around of the first counter word
+    const alea::ars4x32::domain_type start = {{0xffffffef, 0, 1, 2}};
+
+    for (const alea::ars4x32 &cipher : ciphers) {
+        std::vector<std::uint32_t> reference(nblocks * 4);
+        cipher.encrypt_blocks(alea::impl::aes_impl::software, start,
+                              reference.data(), nblocks);
+
+        // zero counter, same value for all the implementations
+        alea::ars4x32::range_type zero_reference;
+        cipher.encrypt_blocks(alea::impl::aes_impl::software,
+                              {{0, 0, 0, 0}}, zero_reference.data(), 1);
+
+        for (alea::impl::aes_impl aes :
+             {alea::impl::aes_impl::software, alea::impl::aes_impl::aes_ni}) {
+            if (!alea::impl::aes_impl_supported(aes)) {
+                std::cout << "aes implementation not supported: "
+                          << alea::impl::aes_impl_name(aes) << "\n";
+                continue;
+            }
+
+            std::vector<std::uint32_t> res(nblocks * 4);
+            cipher.encrypt_blocks(aes, start, res.data(), nblocks);
+            BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                          reference.begin(), reference.end());
+
+            alea::ars4x32::range_type zero;
+            cipher.encrypt_blocks(aes, {{0, 0, 0, 0}}, zero.data(), 1);
+            BOOST_CHECK_EQUAL_COLLECTIONS(zero.begin(), zero.end(),
+                                          zero_reference.begin(),
+                                          zero_reference.end());
+        }
+
+        // single block and runtime dispatched bulk versions
+        const alea::ars4x32::range_type block = cipher(start);
+        BOOST_CHECK_EQUAL_COLLECTIONS(block.begin(), block.end(),
+                                      reference.begin(),
+                                      reference.begin() + 4);
+
+        std::vector<std::uint32_t> res(nblocks * 4);
+        cipher(start, res.data(), nblocks);
+        BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                      reference.begin(), reference.end());
+    }
+
+    // ars4x32 of Random123 ( ars1xm128i, R = 7 ) on the inputs of its
+    // kat_vectors, computed with a byte level FIPS-197 AES model
+    // independent of impl/aes_soft.hpp: checks the key schedule and the
+    // round structure shared by all the implementations
+    struct ars_known_answer {
+        alea::ars4x32::domain_type ctr;
+        alea::ars4x32::key_type key;
+        alea::ars4x32::range_type expected;
+    };
+    const ars_known_answer known_answers[] = {
+        {{{0, 0, 0, 0}},
+         {{0, 0, 0, 0}},
+         {{0xdacf61ff, 0xc45798f3, 0x113c7eeb, 0x101e27f3}}},
+        {{{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}},
+         {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}},
+         {{0xfbaaff1f, 0xbb547ef9, 0x13d8cd78, 0x7aaa969b}}},
+        {{{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}},
+         {{0xa4093822, 0x299f31d0, 0x082efa98, 0xec4e6c89}},
+         {{0xd1df87af, 0xf67d43ba, 0x4f66afdb, 0x393dcb2d}}}};
+
+    for (const ars_known_answer &kat : known_answers) {
+        const alea::ars4x32 cipher(kat.key);
+        for (alea::impl::aes_impl aes :
+             {alea::impl::aes_impl::software, alea::impl::aes_impl::aes_ni}) {
+            if (!alea::impl::aes_impl_supported(aes)) {
+                continue;
+            }
+            alea::ars4x32::range_type res;
+            cipher.encrypt_blocks(aes, kat.ctr, res.data(), 1);
+            BOOST_CHECK_EQUAL_COLLECTIONS(res.begin(), res.end(),
+                                          kat.expected.begin(),
+                                          kat.expected.end());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(splitmix64_known_answer) {
+    // first outputs of the reference splitmix64 sequence seeded with 0
+    alea::counter_engine<alea::splitmix64> engine;
+
+    const std::uint64_t expected[] = {0xe220a8397b1dcdafULL,
+                                      0x6e789e6aa1b965f4ULL,
+                                      0x06c45d188009454fULL};
+    for (std::uint64_t v : expected) {
+        BOOST_CHECK_EQUAL(engine(), v);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(squares_known_answer) {
+    // raw rounds against the C code of Widynski ( arXiv:2004.06278 ),
+    // where the round constant is the key
+    const std::uint64_t key = 0x548c9decbce65297ULL;
+    const std::uint64_t ctrs[] = {0, 1, 2, 12345, ~std::uint64_t(0)};
+    const std::uint32_t expected32[] = {0x36d88366, 0x944716e0, 0xc8a8f4e0,
+                                        0xe7f73f3d, 0x434506a4};
+    const std::uint64_t expected64[] = {
+        0x36d88366cee633a5ULL, 0x944716e00e60dfaaULL, 0xc8a8f4e0678654bfULL,
+        0xe7f73f3d3c9e7b05ULL, 0x434506a445777020ULL};
+
+    for (std::size_t i = 0; i < std::size(ctrs); ++i) {
+        BOOST_CHECK_EQUAL(alea::impl::squares32(ctrs[i], key, key),
+                          expected32[i]);
+        BOOST_CHECK_EQUAL(alea::impl::squares64(ctrs[i], key, key),
+                          expected64[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(counter_hash_distribute, T,
+                              counter_hash_types) {
+    boost::random::uniform_int_distribution<boost::uint64_t> dist100(0, 100);
+
+    // the zero key is valid
+    alea::counter_engine<T> hash_engine;
+
+    const std::uint64_t n_normalize = 100000;
+    std::uint64_t res = 0;
+    for (std::uint64_t i = 0; i < n_normalize; ++i) {
+        res += dist100(hash_engine);
+    }
+
+    const std::uint64_t mean = res / n_normalize;
+    std::cout << "n_normalize_counter_hash: " << mean << "\n";
+    BOOST_CHECK_GE(mean, 49);
+    BOOST_CHECK_LE(mean, 51);
+
+    // close keys give unrelated streams
+    const typename T::key_type key = {{0}}, key_next = {{1}};
+    const T cipher(key), cipher_next(key_next);
+    std::size_t n_equal = 0;
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        n_equal += (cipher({{i}})[0] == cipher_next({{i}})[0]) ? 1 : 0;
+    }
+    BOOST_CHECK_LE(n_equal, 1);
+}
+
+BOOST_AUTO_TEST_CASE(squares_key_mix) {
+    // a bijection of the 63 low bits: no two keys share a squares key
+    std::set<std::uint64_t> mixed;
+    for (std::uint64_t i = 0; i < 100000; ++i) {
+        for (std::uint64_t key : {i, i << 40, (std::uint64_t(1) << 62) + i}) {
+            const std::uint64_t mix = alea::impl::squares_key_mix(key);
+            BOOST_CHECK_LT(mix, std::uint64_t(1) << 63);
+            mixed.insert(mix);
+        }
+    }
+    BOOST_CHECK_EQUAL(mixed.size(), 3 * 100000 - 1);
+
+    // the top bit of the key gives another stream
+    const std::uint64_t top = std::uint64_t(1) << 63;
+    for (std::uint64_t r : {std::uint64_t(5), std::uint64_t(0x123456789)}) {
+        alea::counter_engine<alea::squares64> engine(r), engine_top(r | top);
+        std::size_t n_equal = 0;
+        for (std::size_t i = 0; i < 1000; ++i) {
+            n_equal += engine() == engine_top() ? 1 : 0;
+        }
+        BOOST_CHECK_LE(n_equal, 1);
+    }
+}
+
+// stateful engines with jump ahead and derivation
+typedef boost::mpl::list<alea::xoshiro256ss, alea::pcg64_dxsm>
+    stateful_types;
+
+BOOST_AUTO_TEST_CASE(xoshiro256ss_known_answer) {
+    // reference outputs for the state { 1, 2, 3, 4 }
+    alea::xoshiro256ss engine(alea::xoshiro256ss::state_type{{1, 2, 3, 4}});
+
+    const std::uint64_t expected[] = {11520ULL,
+                                      0ULL,
+                                      1509978240ULL,
+                                      1215971899390074240ULL,
+                                      1216172134540287360ULL,
+                                      607988272756665600ULL,
+                                      16172922978634559625ULL,
+                                      8476171486693032832ULL};
+    for (std::uint64_t v : expected) {
+        BOOST_CHECK_EQUAL(engine(), v);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(xoshiro256ss_jump_polynomials) {
+    // the jump polynomials published with xoshiro256 are
+    // x^(2^128) and x^(2^192) modulo the characteristic polynomial
+    const alea::impl::gf2_polynomial<256> &modulus =
+        alea::xoshiro256ss::characteristic_polynomial();
+
+    const alea::impl::gf2_polynomial<256> jump =
+        alea::impl::gf2_pow2_x<256>(128, modulus);
+    const alea::impl::gf2_polynomial<256> expected_jump = {
+        {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL,
+         0x39abdc4529b1661cULL, 0}};
+    BOOST_CHECK_EQUAL_COLLECTIONS(jump.begin(), jump.end(),
+                                  expected_jump.begin(), expected_jump.end());
+
+    const alea::impl::gf2_polynomial<256> long_jump =
+        alea::impl::gf2_pow2_x<256>(192, modulus);
+    const alea::impl::gf2_polynomial<256> expected_long_jump = {
+        {0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL,
+         0x39109bb02acbe635ULL, 0}};
+    BOOST_CHECK_EQUAL_COLLECTIONS(long_jump.begin(), long_jump.end(),
+                                  expected_long_jump.begin(),
+                                  expected_long_jump.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(stateful_advance, T, stateful_types) {
+    // above the step limit of xoshiro256ss
+    for (std::uint64_t n : {0, 1, 2, 63, 1000, 12345, 65537, 200003}) {
+        T engine(42), engine_advance(42), engine_discard(42);
+        for (std::uint64_t i = 0; i < n; ++i) {
+            (void)engine();
+        }
+        engine_advance.advance(n);
+        engine_discard.discard(n);
+
+        BOOST_CHECK(engine == engine_advance);
+        BOOST_CHECK(engine == engine_discard);
+        BOOST_CHECK_EQUAL(engine(), engine_advance());
+    }
+
+    // signed skips are accepted, the negative ones rejected
+    T signed_discard(42), reference(42);
+    signed_discard.discard(5);
+    reference.advance(5);
+    BOOST_CHECK_THROW(signed_discard.discard(-1), std::invalid_argument);
+    BOOST_CHECK(signed_discard == reference);
+
+    // wide skips are not truncated
+    T wide(42), halves(42);
+    wide.discard(__uint128_t(1) << 64 | 3u);
+    halves.advance(UINT64_C(1) << 63);
+    halves.advance(UINT64_C(1) << 63);
+    halves.advance(3);
+    BOOST_CHECK(wide == halves);
+
+    // jumps are advances by large powers of two
+    T engine(42), engine_jump(42), engine_long_jump(42);
+    engine_jump.jump();
+    engine_long_jump.long_jump();
+    BOOST_CHECK(engine != engine_jump);
+    BOOST_CHECK(engine_jump != engine_long_jump);
+    BOOST_CHECK_NE(engine(), engine_jump());
+}
+
+BOOST_AUTO_TEST_CASE(pcg64_dxsm_jump) {
+    alea::pcg64_dxsm engine(42), engine_jump(42), engine_long_jump(42);
+
+    engine_jump.jump();
+    for (int i = 0; i < 2; ++i) {
+        engine.advance(alea::pcg64_dxsm::uint128_type(1) << 63);
+    }
+    BOOST_CHECK(engine == engine_jump);
+
+    engine.seed(42);
+
+    engine_long_jump.long_jump();
+    for (int i = 0; i < (1 << 16); ++i) {
+        engine.advance(alea::pcg64_dxsm::uint128_type(1) << 80);
+    }
+    BOOST_CHECK(engine == engine_long_jump);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(stateful_derivate, T, stateful_types) {
+    const T engine(1234);
+
+    const T derivated_engine = alea::random_engine_derivate(engine, 42),
+            derivated_engine_same = alea::random_engine_derivate(engine, 42),
+            derivated_engine_differ = alea::random_engine_derivate(engine, 43);
+
+    BOOST_CHECK(derivated_engine == derivated_engine_same);
+    BOOST_CHECK(derivated_engine != derivated_engine_differ);
+    BOOST_CHECK(derivated_engine != engine);
+
+    // children are not shifted copies of each other or of the parent
+    T a(engine), b(derivated_engine), c(derivated_engine_differ);
+    std::vector<std::uint64_t> values_a(1000), values_b(1000), values_c(1000);
+    std::generate(values_a.begin(), values_a.end(), std::ref(a));
+    std::generate(values_b.begin(), values_b.end(), std::ref(b));
+    std::generate(values_c.begin(), values_c.end(), std::ref(c));
+    std::sort(values_a.begin(), values_a.end());
+    std::sort(values_b.begin(), values_b.end());
+    std::sort(values_c.begin(), values_c.end());
+
+    std::vector<std::uint64_t> common;
+    std::set_intersection(values_a.begin(), values_a.end(), values_b.begin(),
+                          values_b.end(), std::back_inserter(common));
+    std::set_intersection(values_b.begin(), values_b.end(), values_c.begin(),
+                          values_c.end(), std::back_inserter(common));
+    BOOST_CHECK(common.empty());
+
+    // usable through the runtime mapper
+    alea::random_engine_mapper_64 mapper{T(engine)};
+    alea::random_engine_mapper_64 mapper_derivated = mapper.derivate(42);
+    T reference(derivated_engine);
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(mapper_derivated(), reference());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(mapper_derivate_position) {
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    engine_type engine(42);
+    alea::random_engine_mapper_64 mapper{engine_type(engine)};
+
+    // the mapped engine runs a batch ahead, the children are the ones of
+    // the engine at the same position
+    (void)mapper();
+    const alea::random_engine_mapper_64 at_one(mapper);
+    (void)mapper();
+    alea::random_engine_mapper_64 first = at_one.derivate(42),
+                                  same = at_one.derivate(42),
+                                  second = mapper.derivate(42);
+    engine_type at_one_engine(engine);
+    at_one_engine.discard(1);
+    engine_type first_reference =
+        alea::random_engine_derivate(at_one_engine, 42);
+    const std::uint64_t value = first();
+    BOOST_CHECK_EQUAL(value, first_reference());
+    BOOST_CHECK_EQUAL(value, same());
+    BOOST_CHECK_NE(value, second());
+
+    // every position of the batch, drawn or discarded
+    for (std::size_t pos = 1; pos <= alea::random_engine_mapper_64::buffer_size;
+         ++pos) {
+        alea::random_engine_mapper_64 drawn{engine_type(engine)},
+            discarded{engine_type(engine)};
+        for (std::size_t i = 0; i < pos; ++i) {
+            (void)drawn();
+        }
+        (void)discarded();
+        discarded.discard(pos - 1);
+
+        engine_type moved(engine);
+        moved.discard(pos);
+        alea::random_engine_mapper_64 drawn_child = drawn.derivate(7),
+                                      discarded_child = discarded.derivate(7);
+        engine_type reference = alea::random_engine_derivate(moved, 7);
+        for (int i = 0; i < 10; ++i) {
+            const std::uint64_t v = reference();
+            BOOST_CHECK_EQUAL(drawn_child(), v);
+            BOOST_CHECK_EQUAL(discarded_child(), v);
+        }
+    }
+
+    // at the end of a batch, the child of the engine at the same position
+    for (std::size_t i = 2; i < alea::random_engine_mapper_64::buffer_size;
+         ++i) {
+        (void)mapper();
+    }
+    engine.discard(alea::random_engine_mapper_64::buffer_size);
+    alea::random_engine_mapper_64 child = mapper.derivate(42);
+    engine_type reference = alea::random_engine_derivate(engine, 42);
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(child(), reference());
+    }
+
+    // large generic engines, not saved before the batches: derivated from
+    // the buffered values, then from the engine when less than 4 are left
+    static_assert(!alea::impl::map_engine_intern<std::uint64_t,
+                                                 std::mt19937_64>::keeps_start,
+                  "");
+    for (std::size_t drawn : {5, 62, 64}) {
+        std::mt19937_64 twister(42);
+        alea::random_engine_mapper_64 twister_mapper{std::mt19937_64(twister)};
+        for (std::size_t i = 0; i < drawn; ++i) {
+            (void)twister_mapper();
+        }
+        twister.discard(drawn);
+        alea::random_engine_mapper_64 twister_child =
+            twister_mapper.derivate(3);
+        std::mt19937_64 twister_reference =
+            alea::random_engine_derivate(twister, 3);
+        for (int i = 0; i < 100; ++i) {
+            BOOST_CHECK_EQUAL(twister_child(), twister_reference());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(engine_random_access, T, cbrng_types) {
+    typedef alea::counter_engine<T> engine_type;
+    typedef typename engine_type::result_type result_type;
+
+    engine_type engine(42);
+    std::vector<result_type> values(1000);
+    std::generate(values.begin(), values.end(), std::ref(engine));
+
+    // at() does not depend on the engine state
+    for (std::uint64_t i = 0; i < values.size(); ++i) {
+        BOOST_CHECK_EQUAL(engine.at(i), values[i]);
+    }
+
+    // discard any amount, from any position in the buffered block
+    for (std::uint64_t start : {0, 1, 3, 17}) {
+        for (std::uint64_t skip : {0, 1, 2, 5, 16, 33, 500}) {
+            engine_type discarded(42);
+            for (std::uint64_t i = 0; i < start; ++i) {
+                (void)discarded();
+            }
+            discarded.discard(skip);
+            BOOST_CHECK_EQUAL(discarded(), values[start + skip]);
+            BOOST_CHECK_EQUAL(discarded(), values[start + skip + 1]);
+        }
+    }
+
+    // far positions
+    engine_type far_engine(42);
+    far_engine.discard(12345678901ULL);
+    BOOST_CHECK_EQUAL(far_engine(), engine.at(12345678901ULL));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(engine_wide_jumps, T, cbrng_types) {
+    typedef alea::counter_engine<T> engine_type;
+    typedef typename engine_type::ctr_type ctr_type;
+    typedef typename ctr_type::value_type word_type;
+
+    const std::size_t nelem =
+        std::tuple_size<typename engine_type::range_type>::value;
+
+    // counter arithmetic is exact across words,
+    // single word counters are kept away from their wrap around
+    const word_type max_word = std::numeric_limits<word_type>::max();
+    const word_type jump_blocks =
+        (std::tuple_size<ctr_type>::value > 1) ? max_word : max_word / 2;
+
+    engine_type engine(7), engine_blocks(7);
+    (void)engine();
+    (void)engine_blocks();
+
+    ctr_type blocks;
+    blocks.fill(0);
+    blocks[0] = jump_blocks;
+    engine_blocks.discard_blocks(blocks);
+
+    const alea::impl::counter_wide_uint skip =
+        alea::impl::counter_wide_uint(jump_blocks) * nelem;
+    engine.discard(skip);
+    BOOST_CHECK(engine == engine_blocks);
+    BOOST_CHECK_EQUAL(engine(), engine_blocks());
+
+    BOOST_CHECK(alea::distance(engine_type(7), engine) == skip + 2);
+    BOOST_CHECK(alea::distance(engine, engine) == 0);
+    BOOST_CHECK_THROW(alea::distance(engine, engine_type(7)),
+                      std::invalid_argument);
+    BOOST_CHECK_THROW(alea::distance(engine, engine_type(8)),
+                      std::invalid_argument);
+
+    // small signed and unsigned jumps
+    engine_type a(3), b(3);
+    a.discard(5);
+    for (int i = 0; i < 5; ++i) {
+        (void)b();
+    }
+    BOOST_CHECK(a == b);
+    BOOST_CHECK(alea::distance(engine_type(3), a) == 5);
+
+#ifdef __SIZEOF_INT128__
+    // jumps beyond 2^64 values on the upper counter words
+    if (sizeof(ctr_type) * 8 > 64 + 8) {
+        const __uint128_t big = (__uint128_t(1) << 64) * nelem + 3;
+        engine_type wide(11), wide_blocks(11);
+        wide.discard(big);
+
+        blocks.fill(0);
+        if (std::numeric_limits<word_type>::digits == 32) {
+            blocks[2] = 1;
+        } else {
+            blocks[1] = 1;
+        }
+        wide_blocks.discard_blocks(blocks);
+        wide_blocks.discard(3);
+
+        BOOST_CHECK(wide == wide_blocks);
+        BOOST_CHECK_EQUAL(wide(), wide_blocks());
+        BOOST_CHECK(alea::distance(engine_type(11), wide) == big + 1);
+    }
+#endif
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(compact_engine, T, cbrng_types) {
+    typedef alea::compact_counter_engine<T> compact_type;
+    typedef typename compact_type::result_type result_type;
+
+    typename T::key_type key;
+    key.fill(0);
+    key[0] = 42;
+    const T cipher(key);
+
+    for (std::uint32_t stream : {0u, 1u, 7u, 0xffffffffu}) {
+        compact_type compact(cipher, stream);
+
+        // same stream than the expanded counter_engine
+        alea::counter_engine<T> expanded = compact.expand();
+        std::vector<result_type> values(100);
+        std::generate(values.begin(), values.end(), std::ref(expanded));
+
+        for (std::uint32_t i = 0; i < values.size(); ++i) {
+            BOOST_CHECK_EQUAL(compact.at(i), values[i]);
+        }
+
+        // one by one, by blocks and in bulk from any position
+        compact_type one(cipher, stream), bulk(cipher, stream),
+            blocks(cipher, stream);
+        for (std::size_t i = 0; i < 10; ++i) {
+            BOOST_CHECK_EQUAL(one(), values[i]);
+        }
+
+        std::vector<result_type> bulk_values(values.size());
+        bulk.fill(bulk_values.begin(), bulk_values.begin() + 3);
+        bulk.fill(bulk_values.begin() + 3, bulk_values.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(bulk_values.begin(), bulk_values.end(),
+                                      values.begin(), values.end());
+        BOOST_CHECK_EQUAL(bulk.position(), values.size());
+
+        const typename T::range_type block = blocks.generate_block();
+        BOOST_CHECK_EQUAL_COLLECTIONS(block.begin(), block.end(),
+                                      values.begin(),
+                                      values.begin() + block.size());
+        BOOST_CHECK_EQUAL(blocks(), values[block.size()]);
+
+        // blocks from an unaligned position continue the stream
+        compact_type mixed(cipher, stream);
+        std::size_t next = 0;
+        BOOST_CHECK_EQUAL(mixed(), values[next++]);
+        for (int round = 0; round < 3; ++round) {
+            const typename T::range_type unaligned = mixed.generate_block();
+            BOOST_CHECK_EQUAL_COLLECTIONS(unaligned.begin(), unaligned.end(),
+                                          values.begin() + next,
+                                          values.begin() + next +
+                                              unaligned.size());
+            next += unaligned.size();
+            BOOST_CHECK_EQUAL(mixed(), values[next++]);
+
+            result_type pair[2];
+            mixed.generate_n(pair, 2);
+            BOOST_CHECK_EQUAL(pair[0], values[next++]);
+            BOOST_CHECK_EQUAL(pair[1], values[next++]);
+        }
+        BOOST_CHECK_EQUAL(mixed.position(), next);
+    }
+
+    // streams are distinct
+    compact_type a(cipher, 1), b(cipher, 2);
+    BOOST_CHECK(a != b);
+    BOOST_CHECK_NE(a.at(0), b.at(0));
+
+    // the end of a stream throws instead of replaying it
+    const std::uint32_t last = std::numeric_limits<std::uint32_t>::max() - 1;
+    compact_type end(cipher, 3);
+    end.discard(last);
+    BOOST_CHECK_EQUAL(end.position(), last);
+    compact_type end_bulk(end);
+    BOOST_CHECK_THROW(end.discard(2), std::out_of_range);
+    BOOST_CHECK_EQUAL(end.position(), last);
+    result_type tail[2];
+    BOOST_CHECK_THROW(end_bulk.generate_n(tail, 2), std::out_of_range);
+    BOOST_CHECK(end_bulk == end);
+    end_bulk.generate_n(tail, 1);
+    BOOST_CHECK_EQUAL(tail[0], end.at(last));
+    BOOST_CHECK_EQUAL(end(), end.at(last));
+    BOOST_CHECK_THROW(end(), std::out_of_range);
+    BOOST_CHECK_THROW(end.discard(1), std::out_of_range);
+    end.discard(0);
+    BOOST_CHECK(end == end_bulk);
+}
+
+typedef boost::mpl::list<alea::threefry2x32, alea::threefry4x32,
+                         alea::threefry2x64, alea::threefry4x64,
+                         alea::philox4x32, alea::chacha8>
+    keyed_batch_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(keyed_batch, T, keyed_batch_types) {
+    typedef alea::keyed_batch<T> batch_type;
+    typedef typename T::key_type key_type;
+    typedef typename T::domain_type domain_type;
+    typedef typename T::range_type range_type;
+
+    // not a multiple of any lane count, to exercise the scalar tail
+    const std::size_t n = 203;
+
+    std::vector<key_type> keys(n);
+    std::vector<domain_type> counters(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        keys[i].fill(0);
+        keys[i][0] = i;
+        keys[i][keys[i].size() - 1] = 3 * i + 1;
+        counters[i].fill(0);
+        counters[i][0] = 5 * i;
+        counters[i][counters[i].size() - 1] = i;
+    }
+
+    const batch_type batch(keys.data(), n);
+    BOOST_CHECK_EQUAL(batch.size(), n);
+
+    domain_type shared;
+    shared.fill(0);
+    shared[0] = 42;
+
+    std::vector<range_type> ref_shared(n), ref(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const T cipher(keys[i]);
+        ref_shared[i] = cipher(shared);
+        ref[i] = cipher(counters[i]);
+    }
+
+    std::vector<range_type> res(n);
+    batch(shared, res.data());
+    BOOST_CHECK(res == ref_shared);
+
+    batch(counters.data(), res.data());
+    BOOST_CHECK(res == ref);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(keyed_batch_kernels, T, threefry_types) {
+    typedef alea::keyed_batch<T> batch_type;
+    typedef typename T::key_type key_type;
+    typedef typename T::domain_type domain_type;
+    typedef typename T::range_type range_type;
+
+    const std::size_t n = 77;
+
+    std::vector<key_type> keys(n);
+    std::vector<domain_type> counters(2 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        keys[i].fill(i);
+        keys[i][0] = ~keys[i][0];
+    }
+    for (std::size_t i = 0; i < counters.size(); ++i) {
+        counters[i].fill(0);
+        counters[i][0] = i;
+    }
+
+    // every other counter
+    std::vector<range_type> ref(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        ref[i] = T(keys[i])(counters[2 * i]);
+    }
+
+    const batch_type batch(keys.data(), n);
+
+    for (alea::impl::simd_isa isa :
+         {alea::impl::simd_isa::scalar, alea::impl::simd_isa::avx2,
+          alea::impl::simd_isa::avx512}) {
+        if (!alea::impl::simd_isa_supported(isa)) {
+            continue;
+        }
+
+        std::vector<range_type> res(n);
+        batch.encrypt(isa, counters.data(), 2, res.data());
+        BOOST_CHECK(res == ref);
+    }
+}
+
+typedef boost::mpl::list<alea::threefry4x64, alea::threefry2x64,
+                         alea::threefry4x32, alea::philox4x32, alea::chacha8>
+    random_key_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(random_key_split, T, random_key_types) {
+    typedef typename T::key_type key_type;
+
+    key_type root;
+    root.fill(0);
+    root[0] = 42;
+
+    // more children than a chunk of blocks
+    const std::size_t n = 150;
+    const std::vector<key_type> children = alea::split<T>(root, n);
+    BOOST_CHECK_EQUAL(children.size(), n);
+
+    std::set<key_type> unique(children.begin(), children.end());
+    unique.insert(root);
+    BOOST_CHECK_EQUAL(unique.size(), n + 1);
+
+    // a prefix of a larger split
+    const std::vector<key_type> more = alea::split<T>(root, n + 7);
+    BOOST_CHECK(std::equal(children.begin(), children.end(), more.begin()));
+
+    // batched split of several parents
+    std::vector<key_type> parents = alea::split<T>(children[1], 13);
+    parents.push_back(root);
+    std::vector<key_type> batched(parents.size() * n);
+    alea::split<T>(parents.data(), parents.size(), n, batched.data());
+    for (std::size_t k = 0; k < parents.size(); ++k) {
+        const std::vector<key_type> ref = alea::split<T>(parents[k], n);
+        BOOST_CHECK(std::equal(ref.begin(), ref.end(),
+                               batched.begin() + k * n));
+    }
+
+    // fold_in is deterministic and gives distinct keys
+    BOOST_CHECK(alea::fold_in<T>(root, 7) == alea::fold_in<T>(root, 7));
+    BOOST_CHECK(alea::fold_in<T>(root, 7) != alea::fold_in<T>(root, 8));
+    BOOST_CHECK(alea::fold_in<T>(root, 0) != children[0]);
+    BOOST_CHECK(alea::fold_in<T>(children[0], 1) !=
+                alea::fold_in<T>(children[1], 1));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(random_key_bits, T, random_key_types) {
+    typedef typename T::key_type key_type;
+    typedef typename T::uint_type uint_type;
+
+    key_type key;
+    key.fill(0);
+    key[0] = 42;
+
+    // the shorter output is a prefix of the longer one
+    const std::vector<uint_type> bits = alea::random_bits<T>(key, 1001);
+    const std::vector<uint_type> prefix = alea::random_bits<T>(key, 3);
+    BOOST_CHECK(std::equal(prefix.begin(), prefix.end(), bits.begin()));
+
+    // independent of the counter_engine stream of the same key
+    alea::counter_engine<T> engine(key);
+    std::vector<uint_type> stream(bits.size());
+    engine.fill(stream.begin(), stream.end());
+    BOOST_CHECK(stream != bits);
+
+    double sum = 0;
+    for (uint_type b : bits) {
+        sum += double(b) / double(std::numeric_limits<uint_type>::max());
+    }
+    BOOST_CHECK_CLOSE(sum / bits.size(), 0.5, 10);
+}
+
+BOOST_AUTO_TEST_CASE(random_key_compact_disjoint) {
+    // two counter words: the compact stream ids share the last word
+    // with the operation tags
+    typedef alea::threefry2x64 cbrng_type;
+    typedef cbrng_type::key_type key_type;
+    typedef alea::compact_counter_engine<cbrng_type> compact_type;
+
+    const key_type root = {{42, 7}};
+    const cbrng_type cipher(root);
+    const std::size_t n = 64;
+
+    std::set<std::uint64_t> key_words;
+    for (const key_type &child : alea::split<cbrng_type>(root, n)) {
+        key_words.insert(child.begin(), child.end());
+    }
+    for (std::uint64_t data = 0; data < n; ++data) {
+        const key_type folded = alea::fold_in<cbrng_type>(root, data);
+        key_words.insert(folded.begin(), folded.end());
+    }
+    for (std::uint64_t bits : alea::random_bits<cbrng_type>(root, 2 * n)) {
+        key_words.insert(bits);
+    }
+    BOOST_CHECK_EQUAL(key_words.size(), 6 * n);
+
+    for (std::uint32_t stream = 0; stream < 8; ++stream) {
+        compact_type compact(cipher, stream);
+        for (std::size_t i = 0; i < 2 * n; ++i) {
+            BOOST_CHECK(key_words.count(compact()) == 0);
+        }
+    }
+}
+
+typedef boost::mpl::list<alea::counter_engine<alea::threefry4x64>,
+                         alea::counter_engine<alea::philox2x64>,
+                         alea::counter_engine<alea::splitmix64>,
+                         alea::xoshiro256ss, std::mt19937_64>
+    variant_engine_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(variant_mapper, T, variant_engine_types) {
+    T engine(42);
+    alea::variant_engine_mapper_64 mapper{T(engine)};
+    BOOST_REQUIRE(mapper.get_if<T>() != nullptr);
+
+    // same stream than the engine, value by value and in batches
+    std::vector<std::uint64_t> reference(1000), values(1000);
+    std::generate(reference.begin(), reference.end(), std::ref(engine));
+    for (std::size_t i = 0; i < 10; ++i) {
+        values[i] = mapper();
+    }
+    mapper.fill(values.begin() + 10, values.begin() + 500);
+    mapper.generate_n(values.begin() + 500, 500);
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(),
+                                  reference.begin(), reference.end());
+    BOOST_CHECK(*mapper.get_if<T>() == engine);
+
+    // copyable, seed and derivate as the mapped engine
+    alea::variant_engine_mapper_64 copy(mapper);
+    BOOST_CHECK(copy == mapper);
+    BOOST_CHECK_EQUAL(copy(), engine());
+
+    mapper.seed(7);
+    engine.seed(7);
+    BOOST_CHECK_EQUAL(mapper(), engine());
+
+    alea::variant_engine_mapper_64 derivated = mapper.derivate(42);
+    T derivated_reference = alea::random_engine_derivate(engine, 42);
+    BOOST_CHECK_EQUAL(derivated.index(), mapper.index());
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(derivated(), derivated_reference());
+    }
+
+    // usable with the distributions
+    boost::random::uniform_int_distribution<int> dist(0, 100);
+    for (int i = 0; i < 100; ++i) {
+        const int v = dist(mapper);
+        BOOST_CHECK_GE(v, 0);
+        BOOST_CHECK_LE(v, 100);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(variant_mapper_32) {
+    alea::variant_engine_mapper_32 mapper{std::mt19937()};
+    alea::random_engine_mapper_32 virtual_mapper{std::mt19937()};
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(mapper(), virtual_mapper());
+    }
+
+    // default to a counter engine
+    alea::variant_engine_mapper_32 default_mapper;
+    alea::counter_engine<alea::threefry4x32> engine;
+    BOOST_CHECK_EQUAL(default_mapper.index(), 0u);
+    BOOST_CHECK_EQUAL(default_mapper(), engine());
+}
+
+typedef boost::mpl::list<alea::counter_engine<alea::threefry4x64>,
+                         alea::xoshiro256ss, boost::random::mt19937_64>
+    mapper_engine_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(mapper_batches, T, mapper_engine_types) {
+    typedef alea::random_engine_mapper_64 mapper_type;
+
+    T engine(42);
+    mapper_type mapper{T(engine)};
+
+    const std::size_t n = 5 * mapper_type::buffer_size + 3;
+    std::vector<std::uint64_t> reference(n), values(n);
+    std::generate(reference.begin(), reference.end(), std::ref(engine));
+
+    // value by value across the buffer boundaries, then in bulk from
+    // the middle of a buffer
+    const std::size_t split = mapper_type::buffer_size + 5;
+    for (std::size_t i = 0; i < split; ++i) {
+        values[i] = mapper();
+    }
+    mapper.fill(values.data() + split, 10);
+    mapper.fill(values.data() + split + 10, n - split - 10);
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(),
+                                  reference.begin(), reference.end());
+    BOOST_CHECK_EQUAL(mapper(), engine());
+
+    // seeding drops the buffered values
+    mapper.seed(7);
+    engine.seed(7);
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK_EQUAL(mapper(), engine());
+    }
+
+    // moved with its buffer
+    mapper_type moved(std::move(mapper));
+    BOOST_CHECK_EQUAL(moved(), engine());
+    mapper = std::move(moved);
+    BOOST_CHECK_EQUAL(mapper(), engine());
+}
+
+namespace {
+
+// memory resource counting the live allocations
+class counting_resource : public std::pmr::memory_resource {
+  public:
+    std::size_t allocations = 0;
+    std::size_t live = 0;
+
+  private:
+    void *do_allocate(std::size_t bytes, std::size_t align) override {
+        ++allocations;
+        ++live;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+
+    void do_deallocate(void *p, std::size_t bytes,
+                       std::size_t align) override {
+        --live;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const
+        noexcept override {
+        return this == &other;
+    }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(mapper_storage) {
+    counting_resource resource;
+
+    {
+        // small engines are stored inline
+        alea::random_engine_mapper_64 mapper(
+            alea::counter_engine<alea::threefry4x64>(42), &resource);
+        BOOST_CHECK(mapper.is_inline());
+
+        alea::random_engine_mapper_64 child = mapper.derivate(1);
+        alea::random_engine_mapper_64 copy(child);
+        BOOST_CHECK(child.is_inline() && copy.is_inline());
+        for (int i = 0; i < 100; ++i) {
+            BOOST_CHECK_EQUAL(child(), copy());
+        }
+
+        alea::random_engine_mapper_64 moved(std::move(copy));
+        BOOST_CHECK(moved.is_inline());
+        BOOST_CHECK_EQUAL(moved(), child());
+        BOOST_CHECK_EQUAL(resource.allocations, 0u);
+    }
+
+    {
+        // the mersenne twister state is allocated from the resource,
+        // as the copies and the derivated engines
+        std::mt19937_64 reference(42);
+        alea::random_engine_mapper_64 mapper(std::mt19937_64(42), &resource);
+        BOOST_CHECK(!mapper.is_inline());
+        BOOST_CHECK_EQUAL(resource.live, 1u);
+
+        alea::random_engine_mapper_64 copy(mapper);
+        alea::random_engine_mapper_64 child = mapper.derivate(1);
+        BOOST_CHECK_EQUAL(resource.live, 3u);
+        for (int i = 0; i < 100; ++i) {
+            const std::uint64_t v = reference();
+            BOOST_CHECK_EQUAL(mapper(), v);
+            BOOST_CHECK_EQUAL(copy(), v);
+        }
+
+        // move steal the allocation, assignment release the old one
+        alea::random_engine_mapper_64 moved(std::move(copy));
+        BOOST_CHECK_EQUAL(resource.live, 3u);
+        moved = child;
+        BOOST_CHECK_EQUAL(resource.live, 3u);
+        moved = alea::random_engine_mapper_64(
+            alea::counter_engine<alea::threefry4x64>(), &resource);
+        BOOST_CHECK(moved.is_inline());
+        BOOST_CHECK_EQUAL(resource.live, 2u);
+    }
+    BOOST_CHECK_EQUAL(resource.live, 0u);
+
+    // inline storage size is configurable
+    alea::random_engine_mapper<std::uint64_t, 16> tiny(
+        alea::counter_engine<alea::threefry4x64>(), &resource);
+    BOOST_CHECK(!tiny.is_inline());
+    BOOST_CHECK_EQUAL(resource.live, 1u);
+}
+
+typedef boost::mpl::list<std::minstd_rand, std::minstd_rand0, std::mt19937,
+                         std::mt19937_64, std::ranlux24, alea::xoshiro256ss,
+                         alea::pcg64_dxsm,
+                         alea::counter_engine<alea::threefry4x64>>
+    jump_engine_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(engine_jump, T, jump_engine_types) {
+    // above the discard threshold of the mersenne twister jump
+    for (unsigned long long n : {0ull, 1ull, 1000ull, 1234567ull}) {
+        T reference(42), jumped(42);
+        reference.discard(n);
+        alea::jump(jumped, n);
+
+        for (int i = 0; i < 1000; ++i) {
+            BOOST_CHECK_EQUAL(jumped(), reference());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(engine_long_jump, T, jump_engine_types) {
+    if (std::is_same<T, std::ranlux24>::value) {
+        // linear discard only
+        return;
+    }
+
+    // jumps are additive
+    const unsigned long long n = (1ull << 40) + 7;
+    T a(42), b(42);
+    alea::jump(a, n);
+    alea::jump(a, n);
+    alea::jump(b, 2 * n);
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(a(), b());
+    }
+
+#ifdef __SIZEOF_INT128__
+    // 128 bits jumps, the mersenne twister ones are too slow unoptimized
+    if (std::is_same<T, std::mt19937>::value ||
+        std::is_same<T, std::mt19937_64>::value) {
+        return;
+    }
+    alea::jump(a, __uint128_t(1) << 64);
+    alea::jump(b, ~0ull);
+    alea::jump(b, 1);
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(a(), b());
+    }
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(mapper_discard) {
+    std::mt19937_64 reference(42);
+    alea::random_engine_mapper_64 mapper{std::mt19937_64(42)};
+    alea::variant_engine_mapper_64 variant_mapper{std::mt19937_64(42)};
+
+    // inside the buffered values, then with a polynomial jump
+    for (unsigned long long n : {3ull, 10ull, 2000000ull}) {
+        const std::uint64_t v = reference();
+        BOOST_CHECK_EQUAL(mapper(), v);
+        BOOST_CHECK_EQUAL(variant_mapper(), v);
+
+        reference.discard(n);
+        mapper.discard(n);
+        variant_mapper.discard(n);
+    }
+    const std::uint64_t v = reference();
+    BOOST_CHECK_EQUAL(mapper(), v);
+    BOOST_CHECK_EQUAL(variant_mapper(), v);
+}
+
+BOOST_AUTO_TEST_CASE(thread_pool_parallel_for) {
+    for (std::size_t concurrency : {1, 2, 3, 8}) {
+        alea::thread_pool pool(concurrency);
+        BOOST_CHECK_EQUAL(pool.concurrency(), concurrency);
+
+        for (std::size_t n : {0, 1, 7, 1000}) {
+            std::vector<std::atomic<int>> visits(n);
+            pool.parallel_for(n, [&](std::size_t i) { ++visits[i]; });
+            for (std::size_t i = 0; i < n; ++i) {
+                BOOST_CHECK_EQUAL(visits[i].load(), 1);
+            }
+        }
+
+        BOOST_CHECK_THROW(pool.parallel_for(100,
+                                            [](std::size_t i) {
+                                                if (i == 42) {
+                                                    throw std::runtime_error(
+                                                        "task failed");
+                                                }
+                                            }),
+                          std::runtime_error);
+
+        // still usable after a failure
+        std::atomic<std::size_t> sum(0);
+        pool.parallel_for(10, [&](std::size_t i) { sum += i; });
+        BOOST_CHECK_EQUAL(sum.load(), 45);
+    }
+}
+
+typedef boost::mpl::list<alea::counter_engine<alea::threefry4x64>,
+                         alea::counter_engine<alea::threefry2x32>,
+                         alea::counter_engine<alea::philox4x32>,
+                         std::minstd_rand, std::mt19937>
+    parallel_fill_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(parallel_fill, T, parallel_fill_types) {
+    const std::size_t n_vals = 10007, grain = 64;
+
+    T origin(1234);
+    // start in the middle of a counter block
+    origin();
+    origin();
+    origin();
+
+    T serial_engine(origin);
+    std::vector<typename T::result_type> serial(n_vals);
+    std::generate(serial.begin(), serial.end(), std::ref(serial_engine));
+
+    for (std::size_t concurrency : {1, 2, 3, 5}) {
+        alea::thread_pool pool(concurrency);
+
+        T engine(origin);
+        std::vector<typename T::result_type> values(n_vals);
+        alea::parallel_fill(engine, values.begin(), values.end(), pool, grain);
+
+        BOOST_CHECK(values == serial);
+        BOOST_CHECK(engine == serial_engine);
+    }
+
+#if defined(__cpp_lib_execution)
+    {
+        T engine(origin);
+        std::vector<typename T::result_type> values(n_vals);
+        alea::parallel_fill(engine, values.begin(), values.end(),
+                            std::execution::par, grain);
+
+        BOOST_CHECK(values == serial);
+        BOOST_CHECK(engine == serial_engine);
+    }
+    {
+        T engine(origin);
+        std::vector<typename T::result_type> values(n_vals);
+        alea::parallel_fill(engine, values.begin(), values.end(),
+                            std::execution::seq);
+
+        BOOST_CHECK(values == serial);
+        BOOST_CHECK(engine == serial_engine);
+    }
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(shared_stream_single_thread) {
+    typedef alea::shared_counter_stream<alea::threefry4x64, 4> shared_type;
+    const alea::threefry4x64::key_type key = {{7, 8, 9, 10}};
+
+    shared_type shared(key);
+    alea::counter_engine<alea::threefry4x64> engine(key);
+
+    {
+        shared_type::local_stream stream = shared.local();
+        for (std::size_t i = 0; i < 100; ++i) {
+            BOOST_CHECK_EQUAL(stream(), engine());
+        }
+
+        std::vector<std::uint64_t> values(1000), expected(1000);
+        stream.generate_n(values.begin(), values.size());
+        engine.generate_n(expected.begin(), expected.size());
+        BOOST_CHECK(values == expected);
+
+        // 1100 values, 16 per lease
+        BOOST_CHECK_EQUAL(stream.stats().leases, 69);
+        BOOST_CHECK_EQUAL(stream.stats().interleaved, 0);
+    }
+
+    BOOST_CHECK_EQUAL(shared.leased_blocks(), 69 * 4);
+    BOOST_CHECK_EQUAL(shared.stats().leases, 69);
+}
+
+BOOST_AUTO_TEST_CASE(shared_stream_threads) {
+    typedef alea::shared_counter_stream<alea::philox4x32> shared_type;
+    const std::size_t n_threads = 4, n_vals = 20000;
+
+    const alea::philox4x32::key_type key = {{1, 2}};
+    shared_type shared(key);
+    std::vector<std::vector<std::uint32_t>> drawn(n_threads);
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&, t] {
+            shared_type::local_stream stream = shared.local();
+            for (std::size_t i = 0; i < n_vals; ++i) {
+                drawn[t].push_back(stream());
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    // every value comes from a distinct position of the stream
+    const std::uint64_t total = shared.leased_blocks() * 4;
+    alea::counter_engine<alea::philox4x32> engine(key);
+    std::vector<std::uint32_t> stream(total);
+    engine.generate_n(stream.begin(), total);
+
+    std::multiset<std::uint32_t> available(stream.begin(), stream.end());
+    for (const std::vector<std::uint32_t> &values : drawn) {
+        for (std::uint32_t v : values) {
+            const auto it = available.find(v);
+            BOOST_REQUIRE(it != available.end());
+            available.erase(it);
+        }
+    }
+
+    const alea::shared_stream_stats stats = shared.stats();
+    BOOST_CHECK_EQUAL(stats.leases, shared.leased_blocks() / 64);
+    BOOST_CHECK_LE(stats.interleaved, stats.leases);
+    BOOST_CHECK_LE(total - n_threads * n_vals, n_threads * 64 * 4);
+}
+
+typedef boost::mpl::list<alea::counter_engine<alea::threefry4x64>,
+                         alea::counter_engine<alea::philox4x32>,
+                         alea::xoshiro256ss, std::mt19937>
+    thread_streams_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(thread_streams_layout, T, thread_streams_types) {
+    const T root(1234);
+    alea::thread_streams<T> streams(root, 5), streams_same(root, 5);
+
+    BOOST_CHECK_EQUAL(streams.size(), 5);
+    BOOST_CHECK_THROW(streams.at(5), std::out_of_range);
+
+    for (std::size_t i = 0; i < streams.size(); ++i) {
+        BOOST_CHECK(streams[i] == streams_same[i]);
+        BOOST_CHECK(streams[i] ==
+                    alea::random_engine_derivate(
+                        root, typename T::result_type(i)));
+
+        // one cache line per engine at least
+        BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(&streams[i]) %
+                              alea::impl::cache_line_size,
+                          0);
+        for (std::size_t j = 0; j < i; ++j) {
+            BOOST_CHECK(streams[i] != streams[j]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(thread_streams_local, T, thread_streams_types) {
+    const std::size_t n_threads = 4, n_vals = 1000;
+
+    const T root(42);
+    alea::thread_streams<T> streams(root, n_threads);
+    std::vector<std::vector<typename T::result_type>> drawn(n_threads);
+
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < n_threads; ++t) {
+        threads.emplace_back([&, t] {
+            alea::set_worker_index(t);
+            for (std::size_t i = 0; i < n_vals; ++i) {
+                drawn[t].push_back(streams.local()());
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+
+    // same values as the serial draws of each worker engine
+    alea::thread_streams<T> expected(root, n_threads);
+    for (std::size_t t = 0; t < n_threads; ++t) {
+        for (std::size_t i = 0; i < n_vals; ++i) {
+            BOOST_CHECK_EQUAL(drawn[t][i], expected[t]());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(thread_streams_local_many_threads) {
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    const std::size_t n_workers = 2, n_rounds = 4;
+
+    const engine_type root(7);
+    alea::thread_streams<engine_type> streams(root, n_workers);
+
+    // successive pools of threads, more threads than workers in total:
+    // each worker index gives the same engine whatever the thread
+    for (std::size_t round = 0; round < n_rounds; ++round) {
+        alea::thread_streams<engine_type> fresh(root, n_workers);
+        std::vector<engine_type::result_type> drawn(n_workers);
+        std::vector<std::thread> threads;
+        for (std::size_t w = 0; w < n_workers; ++w) {
+            threads.emplace_back([&, w] {
+                alea::set_worker_index(w);
+                drawn[w] = fresh.local()();
+            });
+        }
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        for (std::size_t w = 0; w < n_workers; ++w) {
+            BOOST_CHECK_EQUAL(drawn[w], engine_type(streams[w])());
+        }
+    }
+
+    // a thread without index is refused
+    for (std::size_t t = 0; t < n_workers + 1; ++t) {
+        bool refused = false;
+        std::thread thread([&] {
+            try {
+                streams.local();
+            } catch (const std::out_of_range &) {
+                // not a missing index
+            } catch (const std::logic_error &) {
+                refused = true;
+            }
+        });
+        thread.join();
+        BOOST_CHECK(refused);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(counter_engine_at_counter) {
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    const engine_type::key_type key = {{1, 2, 3, 4}};
+
+    engine_type engine(key), skipped(key);
+    BOOST_CHECK(engine == engine_type(key, engine_type::ctr_type{}));
+
+    skipped.discard(5 * 4);
+    engine_type positioned(key, engine_type::ctr_type{{5, 0, 0, 0}});
+    BOOST_CHECK(positioned == skipped);
+    BOOST_CHECK_EQUAL(positioned(), skipped());
+}
+
+typedef boost::mpl::list<alea::threefry4x64, alea::threefry2x64,
+                         alea::philox4x32>
+    monte_carlo_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(monte_carlo_regions, T, monte_carlo_types) {
+    typedef alea::counter_engine<T> engine_type;
+    typedef typename engine_type::result_type value_type;
+    const typename T::key_type key = {{11, 12}};
+    const std::uint64_t n_samples = 1000;
+
+    alea::thread_pool pool(3);
+    const std::vector<value_type> firsts = alea::monte_carlo<T>(
+        n_samples,
+        [](std::uint64_t, engine_type &engine) {
+            return std::vector<value_type>(1, engine());
+        },
+        [](std::vector<value_type> a, const std::vector<value_type> &b) {
+            a.insert(a.end(), b.begin(), b.end());
+            return a;
+        },
+        key, pool, 37);
+
+    // sample i draws from its own counter region, in sample order
+    typedef typename engine_type::ctr_type ctr_type;
+    BOOST_REQUIRE_EQUAL(firsts.size(), n_samples);
+    for (std::uint64_t i = 0; i < n_samples; ++i) {
+        engine_type engine(key, alea::impl::monte_carlo_counter<ctr_type>(i));
+        BOOST_CHECK_EQUAL(firsts[i], engine());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(monte_carlo_key_api_disjoint) {
+    // two counter words: the samples share the last word with the
+    // operation tags of the key API
+    typedef alea::threefry2x64 cbrng_type;
+    typedef alea::counter_engine<cbrng_type> engine_type;
+    typedef cbrng_type::key_type key_type;
+    const key_type key = {{11, 12}};
+    const std::size_t n = 64;
+
+    std::set<std::uint64_t> key_words;
+    for (const key_type &child : alea::split<cbrng_type>(key, n)) {
+        key_words.insert(child.begin(), child.end());
+    }
+    for (std::uint64_t data = 0; data < n; ++data) {
+        const key_type folded = alea::fold_in<cbrng_type>(key, data);
+        key_words.insert(folded.begin(), folded.end());
+    }
+    for (std::uint64_t bits : alea::random_bits<cbrng_type>(key, 2 * n)) {
+        key_words.insert(bits);
+    }
+    BOOST_CHECK_EQUAL(key_words.size(), 6 * n);
+
+    alea::thread_pool pool(2);
+    const std::size_t collisions = alea::monte_carlo<cbrng_type>(
+        8,
+        [&](std::uint64_t, engine_type &engine) {
+            std::size_t res = 0;
+            for (std::size_t i = 0; i < 2 * n; ++i) {
+                res += key_words.count(engine());
+            }
+            return res;
+        },
+        std::plus<std::size_t>(), key, pool);
+    BOOST_CHECK_EQUAL(collisions, 0);
+
+    // nor the stream of counter_engine(key)
+    engine_type stream(key), sample(key, alea::impl::monte_carlo_counter<
+                                             engine_type::ctr_type>(0));
+    BOOST_CHECK_NE(stream(), sample());
+}
+
+BOOST_AUTO_TEST_CASE(monte_carlo_reproducible) {
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    const std::uint64_t n_samples = 100003;
+
+    const auto kernel = [](std::uint64_t, engine_type &engine) {
+        std::uniform_real_distribution<double> dist;
+        const double x = dist(engine), y = dist(engine);
+        return x * x + y * y < 1 ? 4 * x * y : -y / 3;
+    };
+
+    std::vector<double> results;
+    for (std::size_t concurrency : {1, 2, 3, 7}) {
+        alea::thread_pool pool(concurrency);
+        results.push_back(alea::monte_carlo(n_samples, kernel,
+                                            std::plus<double>(), {{5}}, pool,
+                                            100));
+    }
+    for (double res : results) {
+        // bitwise identical
+        BOOST_CHECK(res == results.front());
+    }
+
+    // pi estimate with the default pool
+    const double inside = alea::monte_carlo(
+        n_samples,
+        [](std::uint64_t, engine_type &engine) {
+            std::uniform_real_distribution<double> dist;
+            const double x = dist(engine), y = dist(engine);
+            return x * x + y * y < 1 ? 1.0 : 0.0;
+        },
+        std::plus<double>());
+    BOOST_CHECK_CLOSE(4 * inside / n_samples, 3.14159, 1);
+
+    BOOST_CHECK_EQUAL(
+        alea::monte_carlo(0, kernel, std::plus<double>()), 0.0);
+    // 2^56 regions below the domain byte of a 128 bits counter
+    static_assert(alea::impl::monte_carlo_max_samples<
+                      alea::philox4x32::domain_type>() ==
+                      std::uint64_t(1) << 56,
+                  "");
+    BOOST_CHECK_THROW(alea::monte_carlo<alea::philox4x32>(
+                          (std::uint64_t(1) << 56) + 1,
+                          [](std::uint64_t, auto &) { return 0; },
+                          std::plus<int>()),
+                      std::length_error);
+}
+
+typedef alea::stream_layout<alea::threefry4x64, alea::key_field<20>,
+                            alea::key_field<16>, alea::key_field<10>,
+                            alea::counter_field<16>>
+    job_layout;
+
+BOOST_AUTO_TEST_CASE(stream_layout_packing) {
+    static_assert(job_layout::n_ids == 4, "");
+    static_assert(job_layout::seed_bits == 256 - 46, "");
+    static_assert(job_layout::block_bits == 256 - 8 - 16, "");
+
+    const job_layout::key_type seed = {{1, 2, 3, ~std::uint64_t(0)}};
+
+    // key fields from the most significant bits down, seed elsewhere
+    const job_layout::key_type key = job_layout::key(seed, 0xABCDE, 7, 3, 9);
+    BOOST_CHECK_EQUAL(key[0], 1);
+    BOOST_CHECK_EQUAL(key[1], 2);
+    BOOST_CHECK_EQUAL(key[2], 3);
+    BOOST_CHECK_EQUAL(key[3], (std::uint64_t(0xABCDE) << 44) |
+                                  (std::uint64_t(7) << 28) |
+                                  (std::uint64_t(3) << 18) |
+                                  ((std::uint64_t(1) << 18) - 1));
+
+    // counter fields from just below the domain byte down
+    const job_layout::ctr_type ctr = job_layout::counter(0xABCDE, 7, 3, 9);
+    BOOST_CHECK(ctr ==
+                (job_layout::ctr_type{{0, 0, 0, std::uint64_t(9) << 40}}));
+
+    const job_layout::engine_type engine =
+        job_layout::engine(seed, 0xABCDE, 7, 3, 9);
+    BOOST_CHECK(engine == job_layout::engine_type(key, ctr));
+
+    BOOST_CHECK_THROW(job_layout::key(seed, 1 << 20, 0, 0, 0),
+                      std::out_of_range);
+    BOOST_CHECK_THROW(job_layout::counter(0, 0, 1 << 10, 0),
+                      std::out_of_range);
+
+    // neighbouring ids give distinct streams
+    std::set<std::uint64_t> firsts;
+    for (std::uint64_t job = 0; job < 4; ++job) {
+        for (std::uint64_t thread = 0; thread < 4; ++thread) {
+            for (std::uint64_t sub = 0; sub < 4; ++sub) {
+                job_layout::engine_type e =
+                    job_layout::engine(seed, job, 0, thread, sub);
+                firsts.insert(e());
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(firsts.size(), 64);
+}
+
+BOOST_AUTO_TEST_CASE(stream_layout_end_of_stream) {
+    // 128 bits counter: 120 bits below the domain byte, 2^64 blocks
+    typedef alea::stream_layout<alea::threefry2x64, alea::key_field<8>,
+                                alea::counter_field<56>>
+        layout;
+    static_assert(layout::block_bits == layout::min_block_bits, "");
+
+    const layout::key_type seed = {{42, 0}};
+    const alea::threefry2x64 cipher(layout::key(seed, 1, 0));
+
+    // the last block of the stream 0 is at the counter of the stream 1,
+    // which the stream 1 never computes
+    layout::engine_type last = layout::engine(seed, 1, 0);
+    const std::size_t nelem = 2;
+    last.discard(((__uint128_t(1) << 64) - 1) * nelem);
+    const alea::threefry2x64::range_type block = cipher(layout::counter(1, 1));
+    const std::uint64_t last_values[] = {last(), last()};
+    BOOST_CHECK_EQUAL(last_values[0], block[1]);
+    BOOST_CHECK_EQUAL(last_values[1], block[0]);
+
+    layout::engine_type next = layout::engine(seed, 1, 1);
+    for (int i = 0; i < 100; ++i) {
+        const std::uint64_t v = next();
+        BOOST_CHECK_NE(v, last_values[0]);
+        BOOST_CHECK_NE(v, last_values[1]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(stream_layout_disjoint) {
+    typedef alea::stream_layout<alea::threefry4x64, alea::key_tag<2, 1>,
+                                alea::key_field<30>, alea::counter_field<8>>
+        simulation_layout;
+    typedef alea::stream_layout<alea::threefry4x64, alea::key_tag<2, 2>,
+                                alea::key_field<20>, alea::counter_field<32>>
+        analysis_layout;
+    typedef alea::stream_layout<alea::threefry4x64, alea::key_tag<1, 1>,
+                                alea::key_field<30>>
+        overlapping_layout;
+    typedef alea::stream_layout<alea::philox4x32, alea::counter_tag<3, 5>,
+                                alea::counter_field<16>>
+        counter_layout;
+    typedef alea::stream_layout<alea::philox4x32, alea::counter_tag<3, 4>,
+                                alea::key_field<16>>
+        other_counter_layout;
+
+    static_assert(alea::streams_disjoint<simulation_layout,
+                                         analysis_layout>(),
+                  "");
+    // the top bit is 0 in the simulation tag and 1 in the other one
+    static_assert(alea::streams_disjoint<simulation_layout,
+                                         overlapping_layout>(),
+                  "");
+    // the top bit is 1 in both: an analysis id can match
+    static_assert(!alea::streams_disjoint<analysis_layout,
+                                          overlapping_layout>(),
+                  "");
+    static_assert(!alea::streams_disjoint<job_layout, job_layout>(), "");
+    static_assert(alea::streams_disjoint<counter_layout,
+                                         other_counter_layout>(),
+                  "");
+
+    // tag and field below the domain byte
+    BOOST_CHECK_EQUAL(counter_layout::counter(0xFFFF)[3], 0x00BFFFE0u);
+}
+
+typedef boost::mpl::list<alea::counter_engine<alea::threefry4x64>,
+                         alea::counter_engine<alea::philox4x32>,
+                         std::mt19937>
+    async_engine_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(async_engine_values, T, async_engine_types) {
+    const std::size_t n_vals = 20000;
+    const T origin(1234);
+
+    T engine(origin);
+    std::vector<typename T::result_type> expected(n_vals);
+    std::generate(expected.begin(), expected.end(), std::ref(engine));
+
+    // small ring: the producer waits often and the indices wrap around
+    for (std::size_t capacity : {32, 1000, 1 << 16}) {
+        alea::async_engine<T> async(origin, capacity, 16);
+        BOOST_CHECK_GE(async.capacity(), capacity);
+        BOOST_CHECK_EQUAL(async.chunk_size(), 16);
+
+        std::vector<typename T::result_type> values(n_vals);
+        for (std::size_t i = 0; i < n_vals / 2; ++i) {
+            values[i] = async();
+        }
+        async.generate_n(values.begin() + n_vals / 2, n_vals - n_vals / 2);
+        BOOST_CHECK(values == expected);
+
+        const alea::async_engine_stats stats = async.stats();
+        BOOST_CHECK_EQUAL(stats.stall_ns.count(), stats.consumer_stalls);
+        BOOST_CHECK_GE(stats.chunks, n_vals / 16);
+        BOOST_CHECK_LE(stats.chunk_ns.count(), stats.chunks);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(async_engine_backpressure) {
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+
+    // the producer fills the ring then waits, the destructor stops it
+    alea::async_engine<engine_type> async(engine_type(42), 64, 16);
+    BOOST_CHECK_EQUAL(async(), engine_type(42)());
+
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (async.stats().producer_waits == 0 &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+
+    const alea::async_engine_stats stats = async.stats();
+    BOOST_CHECK_GE(stats.producer_waits, 1);
+    BOOST_CHECK_LE(stats.chunks, 64 / 16 + 1);
+}
+
+typedef boost::mpl::list<alea::counter_engine<alea::threefry4x64>,
+                         alea::counter_engine<alea::threefry2x32>,
+                         alea::counter_engine<alea::philox4x32>,
+                         alea::counter_engine<alea::chacha8>,
+                         alea::counter_engine<alea::squares64>>
+    buffered_engine_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(buffered_engine_values, T,
+                              buffered_engine_types) {
+    T origin(1234);
+    // start in the middle of a block
+    origin();
+
+    T engine(origin);
+    alea::buffered_engine<T, 4> buffered(origin);
+    BOOST_CHECK(buffered.engine() == engine);
+
+    for (std::size_t i = 0; i < 1000; ++i) {
+        BOOST_CHECK_EQUAL(buffered(), engine());
+    }
+    BOOST_CHECK((buffered == alea::buffered_engine<T, 4>(engine)));
+    BOOST_CHECK(buffered.engine() == engine);
+
+    // bulk, across and beyond the buffer
+    for (std::size_t n : {3, 50, 1000}) {
+        std::vector<typename T::result_type> values(n), expected(n);
+        buffered.generate_n(values.begin(), n);
+        std::generate(expected.begin(), expected.end(), std::ref(engine));
+        BOOST_CHECK(values == expected);
+        BOOST_CHECK_EQUAL(buffered(), engine());
+    }
+
+    // discard inside and beyond the buffer
+    for (unsigned long long n : {1ull, 7ull, 100ull, 12345ull}) {
+        buffered.discard(n);
+        engine.discard(n);
+        BOOST_CHECK(buffered.engine() == engine);
+        BOOST_CHECK_EQUAL(buffered(), engine());
+    }
+
+    // a std distribution sees the same stream
+    std::uniform_real_distribution<double> dist;
+    const double x = dist(buffered);
+    BOOST_CHECK_EQUAL(x, dist(engine));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(buffered_engine_derivate, T,
+                              buffered_engine_types) {
+    T engine(42);
+    alea::buffered_engine<T, 4> buffered(engine);
+
+    for (std::size_t i = 0; i < 37; ++i) {
+        BOOST_CHECK_EQUAL(buffered(), engine());
+    }
+
+    // same children as the unbuffered engine at the same position
+    const alea::buffered_engine<T, 4> child =
+        alea::random_engine_derivate(buffered, 7);
+    T engine_child = alea::random_engine_derivate(engine, 7);
+    BOOST_CHECK(child.engine() == engine_child);
+
+    alea::buffered_engine<T, 4> child_copy(child);
+    for (std::size_t i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(child_copy(), engine_child());
+    }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(buffered_engine_stream, T,
+                              buffered_engine_types) {
+    T engine(42);
+    alea::buffered_engine<T, 4> buffered(engine);
+    for (std::size_t i = 0; i < 37; ++i) {
+        BOOST_CHECK_EQUAL(buffered(), engine());
+    }
+
+    // the state of the unbuffered engine at the same position
+    std::stringstream ss, engine_ss;
+    ss << buffered;
+    engine_ss << engine;
+    BOOST_CHECK_EQUAL(ss.str(), engine_ss.str());
+
+    alea::buffered_engine<T, 4> restored;
+    ss >> restored;
+    BOOST_CHECK(!ss.fail());
+    BOOST_CHECK(restored == buffered);
+    for (std::size_t i = 0; i < 100; ++i) {
+        BOOST_CHECK_EQUAL(restored(), buffered());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(buffered_engine_key_derivate) {
+    typedef alea::counter_engine<alea::threefry4x64> engine_type;
+    engine_type engine(engine_type::key_type{{1, 2, 3, 4}});
+    alea::buffered_engine<engine_type> buffered(engine);
+
+    for (std::size_t i = 0; i < 5; ++i) {
+        BOOST_CHECK_EQUAL(buffered(), engine());
+    }
+    const engine_type::key_type key = {{5, 6, 7, 8}};
+    BOOST_CHECK(buffered.derivate(key).engine() == engine.derivate(key));
+
+    buffered.seed(engine_type::key_type{{9}});
+    BOOST_CHECK(buffered.engine() == engine_type(engine_type::key_type{{9}}));
+
+    // engines buffered_engine accepts
+    BOOST_CHECK(alea::has_constant_jump<engine_type>::value);
+    BOOST_CHECK(!alea::has_constant_jump<std::mt19937>::value);
+}